@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include "codec.h"
+
 // Game constants
 #define GAME_WIDTH 20
 #define GAME_HEIGHT 20
@@ -11,92 +13,453 @@
 #define BEAN_SIZE 2
 #define TONGUE_WIDTH 2
 #define TONGUE_SPEED 15.0f
+#define FX_SHIFT 8 // Fixed-point coordinates: 1 game unit = 256
+#define FX_ONE (1 << FX_SHIFT)
+#define TO_FX(v) ((int)((v) * FX_ONE))
+#define TO_FX_ROUND(v) ((int)((v) * FX_ONE + 0.5f)) // Non-negative values only
+#define FX_TO_FLOAT(v) ((v) / (float)FX_ONE)
+// Tongue lattice origin relative to Pyoro's centre (mouth corner of the visual sprite)
+#define TONGUE_START_DX_FX TO_FX(PYORO_VISUAL_SIZE / 2.0f + 0.6f)
+#define TONGUE_START_DY_FX TO_FX(PYORO_VISUAL_SIZE / 2.0f - 0.6f)
 #define BEAN_SPEED 2.2f
+#define BEAN_SPAWN_CHANCE_DENOM 5 // BeanTypeInfo.spawn_chance is out of this
+#define BEAN_ANIMATION_FRAMES 3
 #define PYORO_SPEED 25.0f
 #define PYORO_SINGLE_STEP 0.25f   // Game units per queued step (tiny step)
 #define PYORO_PENDING_STEPS_MAX 60
+#define PYORO_STEPS_PER_TICK 2    // Queued steps drained per simulation tick
 #define BEAN_SPAWN_FREQUENCY 1.2f
 #define SPEED_ACCELERATION 0.01f
+#define SIM_TICK_MS 33 // Fixed simulation step (~30 Hz); rendering runs at FRAME_MS
+#define SIM_DT (SIM_TICK_MS / 1000.0f)
+#define SIM_MAX_TICKS_PER_FRAME 4 // Catch-up cap after a stall
+#define FRAME_MS 16 // Render timer period (~60 FPS)
+#define INTERP_SNAP_DISTANCE 3.0f // Moves larger than this (respawns) are drawn without interpolation
+#define TRACE_CAPACITY 512 // Trace records kept in RAM when built with TRACE (8 bytes each)
+#define TRACE_RECORDS_PER_LINE 8
+#if defined(PBL_PLATFORM_APLITE)
+#define FLIGHT_CAPACITY 128 // Frames kept by the flight recorder (8 bytes each)
+#else
+#define FLIGHT_CAPACITY 256
+#endif
+#define FLIGHT_HITCH_MS 100 // A frame whose update plus draw takes longer is a hitch
+#define FLIGHT_POST_HITCH_FRAMES 32 // Frames still recorded after a hitch before the ring freezes
+#define FLIGHT_RECORDS_PER_KEY (PERSIST_DATA_MAX_LENGTH / 8)
+#define FLIGHT_PERSIST_RECORDS 64 // Newest frames persisted: the hitch and those around it
+#define FLIGHT_VERSION 2 // 2: keys hold packed byte planes
+#if defined(PBL_PLATFORM_APLITE)
+#define REPLAY_MAX_EVENTS 256 // Input events kept for the current run (2 bytes each)
+#define REPLAY_MAX_CHECKPOINTS 32
+#else
+#define REPLAY_MAX_EVENTS 1024
+#define REPLAY_MAX_CHECKPOINTS 128
+#endif
+#define REPLAY_CHECKPOINT_TICKS 150 // State hash every 5 s of simulation
+#define REPLAY_VERSION 2 // 2: held repeats fold into REPLAY_INPUT_REPEAT_RUN events
+// Most of the best run kept in storage; a longer run is stored truncated
+#define REPLAY_PERSIST_MAX_EVENTS (REPLAY_MAX_EVENTS < 768 ? REPLAY_MAX_EVENTS : 768)
+#define REPLAY_PERSIST_MAX_CHECKPOINTS (REPLAY_MAX_CHECKPOINTS < 64 ? REPLAY_MAX_CHECKPOINTS : 64)
+// Keys the best run's replay body can span (events then checkpoints)
+#define REPLAY_PERSIST_MAX_KEYS (PERSIST_BLOB_KEYS(REPLAY_MAX_EVENTS * 2) + \
+                                 PERSIST_BLOB_KEYS(REPLAY_MAX_CHECKPOINTS * 4))
+#define LOG_HEX_BYTES_PER_LINE 64
+#define WATCHDOG_WINDOW 8 // Frames averaged by the frame-budget watchdog
+#define WATCHDOG_BUDGET_MS FRAME_MS // Update plus draw allowed per frame
+#define WATCHDOG_RESTORE_PERCENT 50 // Restore quality once a window averages under this share of budget
 #define DEATH_DELAY 1.0f // Delay in seconds before showing game over screen
+#define DEATH_DELAY_TICKS ((int)(DEATH_DELAY * 1000 / SIM_TICK_MS))
 #define MOUTH_ANIMATION_FRAMES 3 // Number of animation frames (closed, halfway, open)
 #define MOUTH_ANIMATION_SPEED 10 // Frames per animation cycle (higher = slower)
 #define ANGEL_SPEED 35.0f
 #define NUM_BACKGROUNDS 21
 #define SCORE_PER_BACKGROUND 40 // Score points per background step (slow progression)
-#define NUM_HIGH_SCORES 10
-#define PERSIST_KEY_HIGH_SCORES 1
+// On the black & white platforms a decoded full-screen background is a large
+// share of the app heap, so there the backgrounds stay in the resource pack as
+// packed 1-bit rows (tools/pack_background_rows.py) and only the rows that need
+// repainting are streamed through a small strip buffer into the framebuffer.
+#if defined(PBL_PLATFORM_APLITE) || defined(PBL_PLATFORM_DIORITE)
+#define BACKGROUND_STREAMED 1
+#else
+#define BACKGROUND_STREAMED 0
+#endif
+// Optional runtime sky for color platforms: a row gradient plus cloud, hill,
+// skyline and ground bands whose colors and sizes are interpolated from
+// per-stage keyframes by score,
+// so the stage tint fades continuously instead of jumping every
+// SCORE_PER_BACKGROUND points and no background bitmap is decoded.
+#ifndef PROCEDURAL_BACKGROUND
+#define PROCEDURAL_BACKGROUND 0
+#endif
+#if PROCEDURAL_BACKGROUND && defined(PBL_COLOR)
+#define PROCEDURAL_SKY 1
+#else
+#define PROCEDURAL_SKY 0
+#endif
+#define SKY_DESIGN_HEIGHT 144 // Keyframe rows are given in the 144-row background art
+#define SKY_MID_ROW 60
+#define SKY_HORIZON_ROW 118
+#define SKY_HILL_COLUMNS 20   // Hill profile entries, each 8 pixels of the 160-wide art
+#define SKY_HILL_COLUMN_WIDTH 8
+#define SKY_SKYLINE_COLUMNS 10 // Building profile entries, each 16 pixels of the art
+#define SKY_SKYLINE_COLUMN_WIDTH 16
+#define SKY_CLOUD_WIDTH 32     // One cloud lump in the art; the band holds cloud_cover of them
+#define SKY_FLAT_ROW 2         // Dither row with a middle threshold, for single-color bands
+// Parallax clouds (color only): a few sky rows are captured into strip buffers
+// with clouds drawn in, then copied back each frame at a scrolling offset
+#define CLOUD_STRIPS 2
+#define CLOUD_STRIP_MAX_ROWS 8
+#define CLOUD_ROW_MAX_WIDTH 200 // Widest framebuffer row (emery)
+#define CLOUD_BATTERY_SAVER_PERCENT 20 // Clouds stop at or below this charge unless charging
+#define BG_ROWS_HEADER_SIZE 8  // 'B' 'R', bpp, reserved, uint16 width, uint16 height
+#define BG_ROWS_MAX_ROW_BYTES 18 // 144 pixels at 1 bit
+#define BG_STRIP_ROWS 16
+// The color platforms decode stage backgrounds (tools/pack_background_rle.py)
+// into one 8-bit bitmap created at window load, so changing stage mid-run
+// reuses that memory instead of allocating a new bitmap
+#define BACKGROUND_DECODED (!BACKGROUND_STREAMED && !PROCEDURAL_SKY)
+#define BG_FLAG_RLE 1
+#define BG_DECODED_WIDTH 160
+#define BG_DECODED_HEIGHT 144
+#define BG_RLE_CHUNK_BYTES 128 // Runs read per resource load (two bytes each)
+#define NUM_HIGH_SCORES 50         // Leaderboard entries kept (only the top few are shown)
+#define HIGH_SCORES_SHOWN 10
+#define LEGACY_NUM_HIGH_SCORES 10
+#define PERSIST_KEY_HIGH_SCORES 1  // Legacy: int[10] of bare scores, migrated on load
+#define PERSIST_KEY_HIGH_SCORE_ORDER 3 // uint8_t storage slot for each rank
+#define PERSIST_KEY_HIGH_SCORE_SLOT_BASE 100 // One HighScoreEntry per slot key
 #define HIGH_SCORE_EMPTY (-1)
+#define PERSIST_KEY_LIFETIME_STATS 2
+#define PERSIST_KEY_FLIGHT_HEADER 4
+#define PERSIST_KEY_SESSION_OPEN 5 // Set while the app runs; still set at launch after a crash
+#define PERSIST_KEY_BEST_REPLAY_HEADER 6 // ReplayHeader of the best run, written after its body
+#define PERSIST_KEY_FLIGHT_BASE 200 // FLIGHT_RECORDS_PER_KEY flight records per key
+#define PERSIST_KEY_BEST_REPLAY_BASE 300 // Best run's events, then its checkpoints
+#define PERSIST_BLOB_KEYS(size) (((size) + PERSIST_DATA_MAX_LENGTH - 1) / PERSIST_DATA_MAX_LENGTH)
+#define STATS_SCORE_BUCKETS 16    // log2 buckets of score / 10 (catches are worth at least 10)
+#define STATS_SURVIVAL_BUCKETS 12 // log2 buckets of whole seconds survived
+#define NUM_CATCH_BANDS 5         // 10 / 50 / 100 / 300 / 1000 point heights
+#define BENCHMARK_SEED 0x5EED5EEDu
+#define BENCHMARK_SECONDS 20
+#define BENCHMARK_TICKS_PER_BACKGROUND 30 // Cycle through every stage background
 
-// Game state
+// Game state. Coordinates are FX_SHIFT fixed point in int16 (game units
+// are at most GAME_WIDTH/GAME_HEIGHT), flags are bitfields and the block row
+// is two bitmasks, so the whole simulation state is a small flat struct that
+// is cheap to snapshot, copy and hash.
 typedef struct {
-  float x, y;
-  int direction; // 1 = right, -1 = left
-  bool moving;
-  bool dead;
-  bool button_held; // Track if button is being held vs single click
+  int16_t x, y;      // Centre, fixed-point
+  int8_t direction;  // 1 = right, -1 = left
+  uint8_t moving : 1;
+  uint8_t dead : 1;
+  uint8_t button_held : 1; // Track if button is being held vs single click
+  // The tongue always travels on the 45 degree diagonal from its origin, so it
+  // is just an integer extension length; tip, collision and body all derive
+  // from it (tip = start + ext * (direction, -1)).
   struct {
-    bool active;
-    float x, y;
-    int direction;
-    bool going_back;
-    bool caught_bean;
+    int16_t start_x, start_y; // Lattice origin, fixed-point
+    int16_t ext;              // Extension along the diagonal, fixed-point
+    int16_t max_ext;          // Extension at which the tip leaves the playfield
+    int8_t direction;
+    uint8_t active : 1;
+    uint8_t going_back : 1;
+    uint8_t caught_bean : 1;
+    uint8_t catch_band : 3;   // Height band the bean was caught in; lifetime stats only
   } tongue;
 } Pyoro;
 
 typedef enum {
   BEAN_TYPE_GREEN,
-  BEAN_TYPE_PINK
+  BEAN_TYPE_PINK,
+  NUM_BEAN_TYPES
 } BeanType;
 
 typedef struct {
-  float x, y;
-  float speed;
-  bool active;
-  bool caught;
-  BeanType type;
+  int16_t x, y;      // Fixed-point
+  uint8_t speed;     // Fall speed multiplier in hundredths
+  uint8_t active : 1;
+  uint8_t caught : 1;
+  uint8_t type : 2;  // BeanType
 } Bean;
 
+_Static_assert(NUM_BEAN_TYPES <= 4, "bean types are stored in 2 bits");
+
+// What catching a bean does besides scoring
+typedef enum {
+  BEAN_EFFECT_NONE,
+  BEAN_EFFECT_REPAIR, // An angel rebuilds the leftmost missing block
+} BeanEffect;
+
 typedef struct {
-  bool exists;
-  bool is_repairing;
-} Block;
+  uint8_t catch_effect;     // BeanEffect
+  uint8_t score_multiplier; // Applied to the catch height's score band
+  uint8_t spawn_chance;     // Out of BEAN_SPAWN_CHANCE_DENOM; types after green are tried in order
+  bool spawn_needs_hole;    // Only spawned while a block is missing
+  uint8_t fallback_argb;    // GColor8 drawn when the sprites failed to load
+  uint32_t sprites[BEAN_ANIMATION_FRAMES]; // Resource IDs of the animation frames
+} BeanTypeInfo;
+
+static const BeanTypeInfo BEAN_TYPES[NUM_BEAN_TYPES] = {
+  [BEAN_TYPE_GREEN] = {
+    .catch_effect = BEAN_EFFECT_NONE,
+    .score_multiplier = 1,
+    .fallback_argb = GColorGreenARGB8,
+    .sprites = { RESOURCE_ID_GREEN_BEAN_LEFT, RESOURCE_ID_GREEN_BEAN_MIDDLE, RESOURCE_ID_GREEN_BEAN_RIGHT },
+  },
+  [BEAN_TYPE_PINK] = {
+    .catch_effect = BEAN_EFFECT_REPAIR,
+    .score_multiplier = 1,
+    .spawn_chance = 2,
+    .spawn_needs_hole = true,
+    .fallback_argb = GColorFollyARGB8,
+    .sprites = { RESOURCE_ID_PINK_BEAN_LEFT, RESOURCE_ID_PINK_BEAN_MIDDLE, RESOURCE_ID_PINK_BEAN_RIGHT },
+  },
+};
 
 typedef struct {
-  float x, y;
-  bool active;
-  int target_block_index; // Which block to repair
-  bool going_up; // true when going back up after repair
+  int16_t x, y;      // Fixed-point
+  int8_t target_block_index; // Which block to repair
+  uint8_t active : 1;
+  uint8_t going_up : 1; // Set when going back up after repair
 } Angel;
 
 typedef enum {
   GAME_STATE_MENU,
   GAME_STATE_PLAYING,
-  GAME_STATE_GAME_OVER
+  GAME_STATE_GAME_OVER,
+  GAME_STATE_STATS,
+  GAME_STATE_BENCHMARK, // Benchmark results screen
+  GAME_STATE_FLIGHT     // Flight recorder screen (DOWN from stats)
 } GameState;
 
+#define BLOCK_MASK_ALL ((uint32_t)((1ull << GAME_WIDTH) - 1))
+#define MAX_BEANS 48        // Bean pool; normal games use only the first few
+#define MAX_ANGELS 4
+#define NORMAL_BEAN_LIMIT 5 // Max beans on screen outside swarm mode
+#define NORMAL_ANGEL_LIMIT 1
+#define SWARM_SPAWN_RATE 12 // Swarm mode spawns this many times as often
+#define WAVE_MAX_DEPTH 3    // Nested repeat blocks in a wave script, as tools/wavec.py allows
+
+// Wave mode's place in the script. The bytecode itself streams from the
+// resource (see wave_fetch), so only the interpreter registers live here.
+typedef struct {
+  uint16_t pc;                         // Code offset of the next instruction
+  uint16_t wait;                       // Ticks left before pc runs
+  uint16_t loop_start[WAVE_MAX_DEPTH]; // First instruction of each open repeat block
+  uint8_t loop_left[WAVE_MAX_DEPTH];   // Passes left, the current one included
+  uint8_t depth : 2;
+  uint8_t running : 1;                 // Cleared by endless, the end or a bad instruction
+} WaveState;
+
+_Static_assert(WAVE_MAX_DEPTH < 4, "wave depth is stored in 2 bits");
+
 typedef struct {
-  GameState state;
   Pyoro pyoro;
-  Bean beans[5]; // Max 5 beans on screen
-  Block blocks[GAME_WIDTH];
-  Angel angel;
-  int score;
-  float game_speed;
+  Bean beans[MAX_BEANS];
+  Angel angels[MAX_ANGELS];
+  uint32_t blocks;           // Bit i set: block i exists
+  uint32_t blocks_repairing; // Bit i set: an angel is on its way to block i
+  int32_t score;
+  uint32_t ticks;            // Simulation ticks survived this run
+  uint32_t seed;             // Seed for this run, kept with the score for replay
+  uint32_t rng;              // game_rand() state
+  // Single source of truth for game speed (tongue, beans, spawn rate)
+  float speed;
   float bean_spawn_timer;
-  float death_timer;
-  bool game_paused;
+  uint8_t death_ticks;       // Ticks left before the game over screen
+  uint8_t state;             // GameState
+  uint8_t background_index;
+  // Step queue: one small step per unit; drain a few per tick. Enables tap=tiny step, hold=walk.
+  int8_t pending_step_dir;   // -1 left, 0 none, 1 right
+  uint8_t pending_step_count;
+  WaveState wave;
+  uint8_t game_paused : 1;
+  uint8_t benchmark : 1;     // Deterministic stress run: autoplay, no death
+  uint8_t swarm : 1;         // Swarm mode: the full bean and angel pools
+  uint8_t waves : 1;         // Wave mode: beans come from the wave script
 } Game;
 
+_Static_assert(GAME_WIDTH <= 32, "blocks are stored as a uint32_t bitmask");
+_Static_assert(GAME_WIDTH << FX_SHIFT <= INT16_MAX && GAME_HEIGHT << FX_SHIFT <= INT16_MAX,
+               "fixed-point coordinates must fit in int16_t");
+_Static_assert(MAX_BEANS <= 64, "bean broadphase buckets are uint64_t masks");
+// Snapshotted every tick, so both halves are held to their size: the bean
+// pool, and everything else in the struct
+_Static_assert(sizeof(Bean) == 6, "keep Bean at 6 bytes");
+_Static_assert(sizeof(Game) - sizeof(((Game *)0)->beans) <= 96, "keep Game outside the bean pool at 96 bytes");
+
+// Replay of one run: the seed and mode, every input that changed the
+// simulation and the tick it arrived before, and a state hash every
+// REPLAY_CHECKPOINT_TICKS. Dumped over APP_LOG at game over in exactly the
+// file layout below; tools/extract_replays.py writes the dumps out as files
+// for the host tools in tools/host.
+typedef enum {
+  REPLAY_INPUT_NONE, // Padding: advances the tick only
+  REPLAY_INPUT_UP,
+  REPLAY_INPUT_UP_REPEAT,
+  REPLAY_INPUT_DOWN,
+  REPLAY_INPUT_DOWN_REPEAT,
+  REPLAY_INPUT_SELECT,
+  REPLAY_INPUT_REPEAT_RUN, // More repeats of the previous event's input (below)
+} ReplayInput;
+
+// Events are uint16: ticks since the previous event << 3 | ReplayInput.
+// A held button repeats every 100 ms, one event each, which would fill the
+// buffer in under two minutes of walking. So a repeat arriving 2-5 ticks
+// after the same repeat joins a run event instead: bits 3-5 count the
+// repeats in it (1-5), and each one's ticks since the one before, minus 2,
+// follows in two bits from bit 6 up.
+#define REPLAY_EVENT_INPUT_BITS 3
+#define REPLAY_EVENT_INPUT_MASK ((1 << REPLAY_EVENT_INPUT_BITS) - 1)
+#define REPLAY_EVENT_MAX_DELTA (UINT16_MAX >> REPLAY_EVENT_INPUT_BITS)
+#define REPLAY_RUN_MAX 5
+#define REPLAY_RUN_MIN_DELTA 2
+#define REPLAY_RUN_DELTA_SHIFT 6
+#define REPLAY_FLAG_SWARM 1
+#define REPLAY_FLAG_TRUNCATED 2 // Ran out of event slots; only the start replays
+#define REPLAY_FLAG_WAVES 4
+
+typedef struct {
+  uint8_t magic[2];       // 'P', 'R'
+  uint8_t version;
+  uint8_t flags;          // REPLAY_FLAG_*
+  uint32_t seed;
+  uint32_t ticks;         // Ticks survived
+  int32_t score;
+  uint16_t event_count;   // uint16_t events follow the header
+  uint16_t checkpoint_count; // Then uint32_t state hashes, one per interval
+  uint16_t checkpoint_interval;
+  uint16_t reserved;
+} ReplayHeader;
+
+_Static_assert(sizeof(ReplayHeader) == 24, "replay header is 24 bytes on the wire");
+
+// One leaderboard row. Rows live in fixed storage slots (one persist key
+// each) and a separate rank->slot table orders them, so inserting a score
+// rewrites only the new row and the small order table.
+typedef struct {
+  int32_t score;
+  uint32_t timestamp; // Wall-clock time the run ended
+  uint32_t seed;
+  uint16_t duration;  // Seconds survived
+  uint16_t reserved;
+} HighScoreEntry;
+
+_Static_assert(NUM_HIGH_SCORES <= UINT8_MAX, "slot indices are stored as uint8_t");
+_Static_assert(NUM_HIGH_SCORES <= 64, "the order table is checked with a uint64_t mask");
+
+// Lifetime statistics. Every field is a fixed-size counter updated in O(1) per
+// event, so the whole struct fits in a single persist key and the stats
+// screen renders straight from it without keeping any per-game history.
+typedef struct {
+  uint32_t games_played;
+  uint32_t total_score;
+  int32_t best_score;
+  uint32_t total_play_seconds;
+  uint32_t total_blocks_lost;
+  uint32_t catches[NUM_CATCH_BANDS];
+  uint16_t score_histogram[STATS_SCORE_BUCKETS];
+  uint16_t survival_histogram[STATS_SURVIVAL_BUCKETS];
+} LifetimeStats;
+
+_Static_assert(sizeof(LifetimeStats) <= PERSIST_DATA_MAX_LENGTH,
+               "LifetimeStats must fit in one persist key");
+
+// Screen layout derived from the visible (unobstructed) area. Recomputed only
+// when that area actually changes, not per frame.
+typedef struct {
+  GRect bounds;
+  int screen_width, screen_height;
+  int game_pixel_width, game_pixel_height;
+  float scale_x, scale_y;
+  GRect block_rects[GAME_WIDTH];
+} Layout;
+
+// Reasons the game timer and redraws are suspended
+#define SUSPEND_FOCUS_LOST 1  // Notification or other modal on top of the app
+#define SUSPEND_OBSTRUCTED 2  // Quick View / timeline peek covered a run in progress
+
 static Window *s_window;
 static Layer *s_game_layer;
 static TextLayer *s_score_layer;
 static TextLayer *s_game_over_layer;
 static AppTimer *s_game_timer;
 static Game s_game;
+static Layout s_layout;
+static uint8_t s_suspend_reasons = 0;
 static GBitmap *s_background_bitmap;
-static int s_background_index = 0;
-static int s_high_scores[NUM_HIGH_SCORES];
+static int s_loaded_background = -1; // Stage whose background is currently loaded
+#if BACKGROUND_DECODED
+static uint8_t s_background_chunk[BG_RLE_CHUNK_BYTES];
+#endif
+#ifdef DEBUG_HEAP_GUARD
+static size_t s_heap_baseline; // Heap in use when the run started
+static bool s_heap_guard_reported;
+#endif
+#if BACKGROUND_STREAMED
+static ResHandle s_background_rows;
+static uint16_t s_background_rows_width;
+static uint16_t s_background_rows_height;
+static uint8_t s_background_strip[BG_STRIP_ROWS * BG_ROWS_MAX_ROW_BYTES];
+#endif
+// Static scene cache: a copy of the framebuffer holding the background plus
+// the block row. Gameplay frames copy it back in one memcpy and draw only the
+// moving sprites on top. Damage is tracked as a range of framebuffer rows;
+// streamed backgrounds repaint just those rows, bitmap backgrounds redraw all.
+static uint8_t *s_scene_cache;
+static size_t s_scene_cache_capacity; // Reserved at window load for the largest framebuffer
+static size_t s_scene_cache_size;     // Framebuffer bytes, known from the first scene drawn
+#if defined(PBL_COLOR)
+typedef struct {
+  uint8_t top;     // First framebuffer row
+  uint8_t rows;
+  uint8_t speed;   // Pixels per second
+} CloudStrip;
+static const CloudStrip s_cloud_strips[CLOUD_STRIPS] = {
+  { 10, 8, 4 },
+  { 28, 6, 9 },
+};
+static uint8_t s_cloud_pixels[CLOUD_STRIPS][CLOUD_STRIP_MAX_ROWS][CLOUD_ROW_MAX_WIDTH];
+static bool s_clouds_ready = false;
+static bool s_battery_saver = false;
+#endif
+static int16_t s_scene_dirty_top = 0;
+static int16_t s_scene_dirty_bottom = INT16_MAX; // Empty when top >= bottom
+static HighScoreEntry s_high_scores[NUM_HIGH_SCORES]; // Sorted by rank, best first
+static uint8_t s_high_score_slots[NUM_HIGH_SCORES];   // Storage slot holding each rank
 static int s_last_game_score = 0;
+static int s_last_game_rank = -1; // Leaderboard rank of the last run, -1 if unranked
+// Game-over overlay text, formatted once per game over rather than per redraw
+static char s_overlay_score_buf[32];
+static char s_overlay_lines[HIGH_SCORES_SHOWN][24];
+static int s_overlay_highlight_line = -1;
+static bool s_overlay_dirty = true;
+static LifetimeStats s_stats;
+// Benchmark mode (long-press SELECT on the menu): a fixed-seed stress run at
+// full speed whose timings are shown at the end, comparable across platforms
+typedef struct {
+  uint32_t start_ms;
+  uint32_t elapsed_ms;
+  uint32_t ticks;
+  uint32_t frames;
+  uint32_t update_ms_total;
+  uint32_t draw_ms_total;
+  uint32_t update_ms_max;
+  uint32_t draw_ms_max;
+  uint32_t heap_high_water;
+} BenchmarkStats;
+static BenchmarkStats s_benchmark;
+static const int s_catch_band_points[NUM_CATCH_BANDS] = { 10, 50, 100, 300, 1000 };
+#if BACKGROUND_STREAMED
+static const uint32_t s_background_resource_ids[NUM_BACKGROUNDS] = {
+  RESOURCE_ID_BACKGROUND_ROWS_0, RESOURCE_ID_BACKGROUND_ROWS_1, RESOURCE_ID_BACKGROUND_ROWS_2,
+  RESOURCE_ID_BACKGROUND_ROWS_3, RESOURCE_ID_BACKGROUND_ROWS_4, RESOURCE_ID_BACKGROUND_ROWS_5,
+  RESOURCE_ID_BACKGROUND_ROWS_6, RESOURCE_ID_BACKGROUND_ROWS_7, RESOURCE_ID_BACKGROUND_ROWS_8,
+  RESOURCE_ID_BACKGROUND_ROWS_9, RESOURCE_ID_BACKGROUND_ROWS_10, RESOURCE_ID_BACKGROUND_ROWS_11,
+  RESOURCE_ID_BACKGROUND_ROWS_12, RESOURCE_ID_BACKGROUND_ROWS_13, RESOURCE_ID_BACKGROUND_ROWS_14,
+  RESOURCE_ID_BACKGROUND_ROWS_15, RESOURCE_ID_BACKGROUND_ROWS_16, RESOURCE_ID_BACKGROUND_ROWS_17,
+  RESOURCE_ID_BACKGROUND_ROWS_18, RESOURCE_ID_BACKGROUND_ROWS_19, RESOURCE_ID_BACKGROUND_ROWS_20,
+};
+#elif !PROCEDURAL_SKY
 static const uint32_t s_background_resource_ids[NUM_BACKGROUNDS] = {
   RESOURCE_ID_BACKGROUND_0, RESOURCE_ID_BACKGROUND_1, RESOURCE_ID_BACKGROUND_2,
   RESOURCE_ID_BACKGROUND_3, RESOURCE_ID_BACKGROUND_4, RESOURCE_ID_BACKGROUND_5,
@@ -106,6 +469,65 @@ static const uint32_t s_background_resource_ids[NUM_BACKGROUNDS] = {
   RESOURCE_ID_BACKGROUND_15, RESOURCE_ID_BACKGROUND_16, RESOURCE_ID_BACKGROUND_17,
   RESOURCE_ID_BACKGROUND_18, RESOURCE_ID_BACKGROUND_19, RESOURCE_ID_BACKGROUND_20,
 };
+#endif
+#if PROCEDURAL_SKY
+// One keyframe per stage, after the background art: the sunset sinks and its
+// clouds thin through the dusk and evening stages while the town grows on the
+// horizon, then the night stages keep only the town's lights in the stage's
+// accent color
+typedef struct {
+  uint8_t sky_top[3];
+  uint8_t sky_mid[3];
+  uint8_t sky_bottom[3];
+  uint8_t clouds[3];
+  uint8_t hills[3];
+  uint8_t ground_top[3];
+  uint8_t ground_bottom[3];
+  uint8_t lights[3];   // Stars and lit windows
+  uint8_t cloud_row;   // Cloud band centre in the art
+  uint8_t cloud_cover; // Cloud lumps per 160 pixels, 0 for a clear sky
+  uint8_t skyline;     // Tallest building in art rows above the horizon, 0 for none
+  uint8_t stars;
+} SkyKeyframe;
+
+#define SKY_HILLS { 0, 64, 32 }, { 0, 80, 40 }, { 8, 104, 64 }
+#define SKY_BLACK { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }
+static const SkyKeyframe s_sky_keyframes[NUM_BACKGROUNDS] = {
+  { { 48, 24, 144 }, { 128, 104, 120 }, { 232, 208, 104 }, { 240, 184, 136 }, SKY_HILLS, { 248, 248, 248 }, 44, 5, 0, 6 },
+  { { 48, 24, 144 }, { 120, 96, 124 }, { 224, 192, 104 }, { 232, 168, 136 }, SKY_HILLS, { 248, 248, 248 }, 46, 5, 6, 6 },
+  { { 48, 24, 144 }, { 112, 88, 128 }, { 216, 176, 104 }, { 224, 152, 136 }, SKY_HILLS, { 248, 248, 248 }, 48, 4, 10, 7 },
+  { { 48, 24, 144 }, { 104, 76, 128 }, { 204, 156, 100 }, { 208, 136, 136 }, SKY_HILLS, { 248, 248, 248 }, 50, 4, 14, 8 },
+  { { 48, 24, 144 }, { 92, 64, 132 }, { 188, 136, 96 }, { 192, 120, 136 }, SKY_HILLS, { 248, 248, 248 }, 52, 4, 18, 9 },
+  { { 48, 24, 144 }, { 72, 36, 124 }, { 144, 72, 88 }, { 152, 88, 128 }, SKY_HILLS, { 248, 232, 160 }, 54, 3, 24, 10 },
+  { { 46, 22, 140 }, { 66, 30, 120 }, { 128, 56, 84 }, { 128, 72, 120 }, SKY_HILLS, { 248, 224, 144 }, 56, 3, 28, 11 },
+  { { 44, 20, 136 }, { 60, 26, 116 }, { 116, 44, 82 }, { 112, 64, 116 }, SKY_HILLS, { 248, 224, 128 }, 58, 3, 32, 12 },
+  { { 40, 16, 128 }, { 54, 22, 112 }, { 108, 36, 80 }, { 96, 56, 112 }, SKY_HILLS, { 248, 216, 112 }, 60, 2, 36, 14 },
+  { { 32, 12, 112 }, { 48, 20, 108 }, { 96, 32, 84 }, { 80, 48, 108 }, SKY_HILLS, { 248, 216, 96 }, 62, 2, 40, 16 },
+  { { 0, 0, 0 }, { 0, 0, 40 }, { 0, 0, 140 }, { 0, 0, 96 }, SKY_HILLS, { 248, 208, 64 }, 64, 1, 44, 6 },
+  { { 45, 45, 45 }, { 49, 49, 49 }, { 59, 59, 59 }, { 64, 64, 64 }, { 42, 42, 42 }, { 52, 52, 52 }, { 71, 71, 71 },
+    { 200, 200, 200 }, 64, 1, 44, 0 },
+  { SKY_BLACK, { 255, 255, 255 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 255, 0, 48 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 255, 255, 255 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 1, 32, 253 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 33, 251, 2 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 250, 3, 141 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 4, 247, 249 }, 0, 0, 44, 6 },
+  { SKY_BLACK, { 0, 0, 0 }, 0, 0, 0, 0 },
+  { SKY_BLACK, { 255, 244, 0 }, 0, 0, 44, 93 },
+};
+#undef SKY_HILLS
+#undef SKY_BLACK
+// Hill top row per 8-pixel column of the art; SKY_DESIGN_HEIGHT means no hill
+static const uint8_t s_sky_hill_profile[SKY_HILL_COLUMNS] = {
+  75, 83, 91, 91, 99, 115, 144, 144, 144, 144, 115, 144, 144, 107, 115, 144, 144, 115, 115, 107,
+};
+// Building heights per 16-pixel column, in 256ths of the keyframe's skyline
+static const uint8_t s_sky_skyline_profile[SKY_SKYLINE_COLUMNS] = {
+  0, 96, 255, 0, 64, 160, 0, 128, 200, 48,
+};
+static int s_sky_position = 0; // Stage in 8.8 fixed point
+#endif
 static GBitmap *s_pyoro_right_bitmap;
 static GBitmap *s_pyoro_left_bitmap;
 static GBitmap *s_pyoro_mouth_halfway_open_right_bitmap;
@@ -119,443 +541,2324 @@ static GBitmap *s_tongue_bitmap;
 static GBitmap *s_tongue_left_bitmap;
 static GBitmap *s_tongue_body_right_bitmap;
 static GBitmap *s_tongue_body_left_bitmap;
-static GBitmap *s_green_bean_left_bitmap;
-static GBitmap *s_green_bean_middle_bitmap;
-static GBitmap *s_green_bean_right_bitmap;
-static GBitmap *s_pink_bean_left_bitmap;
-static GBitmap *s_pink_bean_middle_bitmap;
-static GBitmap *s_pink_bean_right_bitmap;
+static GBitmap *s_bean_bitmaps[NUM_BEAN_TYPES][BEAN_ANIMATION_FRAMES];
 static GBitmap *s_angel_bitmap;
-static uint32_t s_frame_count = 0;
-#define BEAN_ANIMATION_SPEED 24 // Frames per animation frame (higher = slower)
+#define BEAN_ANIMATION_SPEED 12 // Sim ticks per animation frame (higher = slower)
+
+// Physics runs at a fixed SIM_TICK_MS step; each render interpolates between
+// the state before the last tick and the current one.
+static Game s_prev_game;
+
+// Frame-budget watchdog: each frame's update plus draw cost goes into a short
+// window; over budget sheds the next optional pass, well under budget restores
+// one. A full window must pass between changes, which gives the hysteresis.
+typedef enum {
+  SHED_NONE,
+  SHED_BEAN_ANIMATION, // Beans hold their current animation frame
+  SHED_TONGUE_BODY,    // Draw only the tongue tip
+  SHED_EFFECTS,        // No parallax clouds
+  SHED_HALF_RATE,      // Refresh the static scene every other frame; sprites still every frame
+  SHED_MAX = SHED_HALF_RATE
+} ShedLevel;
+
+static struct {
+  uint16_t cost_ms[WATCHDOG_WINDOW];
+  uint16_t window_ms;   // Sum of cost_ms
+  uint8_t next;
+  uint8_t frames_since_change;
+  uint8_t level;        // ShedLevel
+  uint16_t last_draw_ms;
+  uint32_t bean_animation_ticks; // Animation clock at the moment it was shed
+  bool defer_scene;     // This frame shows the cached scene even if rows are damaged
+} s_watchdog;
+static uint32_t s_sim_accum_ms = 0;   // Wall time not yet simulated
+static uint32_t s_last_frame_ms = 0;
+static int s_interp_alpha = 0;        // 0..256 progress into the next tick
+
+// Wave scripts (resources/waves/*.wave, compiled by tools/wavec.py) run as
+// bytecode streamed from the resource a small window at a time, so a long
+// script costs no more RAM than a short one. The window is only a cache:
+// WaveState in Game is the whole interpreter state.
+#define WAVE_HEADER_SIZE 6      // 'W' 'V', version, reserved, uint16 code size
+#define WAVE_VERSION 1
+#define WAVE_WINDOW_SIZE 32
+#define WAVE_MAX_OPS_PER_TICK 8 // A script that runs this long without a wait yields until the next tick
+#define WAVE_RANDOM 255         // Column or bean type drawn as the random spawner draws it
+
+typedef enum {
+  WAVE_OP_ENDLESS, // Hand over to the random spawner for the rest of the run
+  WAVE_OP_BEAN,    // Column, BeanType, speed (0: random)
+  WAVE_OP_WAIT,    // uint16 ticks
+  WAVE_OP_REPEAT,  // Count; the block follows, closed by WAVE_OP_END
+  WAVE_OP_END,
+  WAVE_OP_GOTO,    // uint16 code offset
+  NUM_WAVE_OPS
+} WaveOp;
 
-// Step queue: one small step per unit; drain one per frame. Enables tap=tiny step, hold=walk.
-static int s_pending_step_dir = 0;   // -1 left, 0 none, 1 right
-static int s_pending_step_count = 0;
+static const uint8_t s_wave_op_sizes[NUM_WAVE_OPS] = { 1, 4, 3, 2, 1, 3 };
 
-// Single source of truth for game speed (tongue, beans, spawn rate). Reset in init/reset.
-static float s_physics_speed = 1.0f;
+static struct {
+  ResHandle handle;
+  uint16_t code_size; // 0 when there is no usable script
+  uint16_t start;     // Code offset of bytes[0]
+  uint8_t length;
+  uint8_t bytes[WAVE_WINDOW_SIZE];
+} s_wave_stream;
 
 // Forward declarations
 static void game_update(void *data);
+static void stop_game_timer(void);
 static void game_layer_update_callback(Layer *layer, GContext *ctx);
+static void prv_click_config_provider(void *context);
 static void init_game(void);
 static void reset_game(void);
 static void spawn_bean(void);
 static void update_game(float delta_time);
-static bool check_collision(float x1, float y1, float w1, float h1,
-                         float x2, float y2, float w2, float h2);
 
-// Apply one horizontal step for Pyoro (used by step queue). Returns true if moved.
-// Step size scales with s_physics_speed so Pyoro moves faster as the game progresses.
-static bool apply_pyoro_step(int step_dir) {
-  float step = PYORO_SINGLE_STEP * s_physics_speed;
-  float new_x = s_game.pyoro.x + step_dir * step;
-  if (new_x < PYORO_SIZE / 2.0f) {
-    new_x = PYORO_SIZE / 2.0f;
-  } else if (new_x > GAME_WIDTH - PYORO_SIZE / 2.0f) {
-    new_x = GAME_WIDTH - PYORO_SIZE / 2.0f;
-  }
-  int block_left = (int)(new_x - PYORO_SIZE / 2.0f);
-  int block_right = (int)(new_x + PYORO_SIZE / 2.0f);
-  for (int i = block_left; i <= block_right && i < GAME_WIDTH; i++) {
-    if (i >= 0 && !s_game.blocks[i].exists) {
+// Support map: for each block column, the first and last column of the
+// unbroken run of blocks containing it (-1 when the column is a hole).
+// Rebuilt only when a block is destroyed or repaired.
+static int8_t s_walk_left[GAME_WIDTH];
+static int8_t s_walk_right[GAME_WIDTH];
+
+// Collision broadphase: for each column, a mask of the free-falling beans
+// whose centre is in it. Rebuilt once per tick after beans move.
+static uint64_t s_bean_columns[GAME_WIDTH];
+
+static uint32_t wall_ms(void) {
+  time_t seconds;
+  uint16_t millis;
+  time_ms(&seconds, &millis);
+  return (uint32_t)seconds * 1000 + millis;
+}
+
+// Event tracing, compiled in with -DTRACE: begin/end markers around the
+// update phases and render passes plus instant events, written as 8-byte
+// records into a RAM ring and dumped as hex over APP_LOG when a run ends.
+// tools/trace_to_chrome.py turns the dump into Chrome/Perfetto trace JSON;
+// keep its event table in step with TraceEvent.
+typedef enum {
+  TRACE_PHASE_BEGIN,
+  TRACE_PHASE_END,
+  TRACE_PHASE_INSTANT
+} TracePhase;
+
+typedef enum {
+  TRACE_UPDATE,
+  TRACE_INPUT,
+  TRACE_TONGUE,
+  TRACE_BEANS,
+  TRACE_ANGELS,
+  TRACE_SPAWN,
+  TRACE_STAGE,
+  TRACE_DRAW,
+  TRACE_DRAW_SCENE,
+  TRACE_DRAW_SPRITES,
+  TRACE_DRAW_OVERLAY,
+  TRACE_BEAN_SPAWNED,  // Instant, arg = bean slot
+  TRACE_BEAN_CAUGHT,   // Instant, arg = points
+  TRACE_PYORO_DIED,    // Instant, arg = score
+} TraceEvent;
+
+#ifdef TRACE
+typedef struct {
+  uint32_t time_ms; // Since the trace was started
+  uint8_t phase;    // TracePhase
+  uint8_t event;    // TraceEvent
+  uint16_t arg;
+} TraceRecord;
+_Static_assert(sizeof(TraceRecord) == 8, "trace records are 8 bytes on the wire");
+
+static TraceRecord s_trace[TRACE_CAPACITY];
+static uint16_t s_trace_next;
+static uint16_t s_trace_count;
+static uint32_t s_trace_start_ms;
+
+static void trace_record(TracePhase phase, TraceEvent event, uint16_t arg) {
+  s_trace[s_trace_next] = (TraceRecord) {
+    .time_ms = wall_ms() - s_trace_start_ms,
+    .phase = phase,
+    .event = event,
+    .arg = arg,
+  };
+  s_trace_next = (s_trace_next + 1) % TRACE_CAPACITY;
+  if (s_trace_count < TRACE_CAPACITY) {
+    s_trace_count++;
+  }
+}
+
+static void trace_reset(void) {
+  s_trace_next = 0;
+  s_trace_count = 0;
+  s_trace_start_ms = wall_ms();
+}
+
+// Oldest record first, TRACE_RECORDS_PER_LINE records per log line
+static void trace_dump(void) {
+  static char line[TRACE_RECORDS_PER_LINE * sizeof(TraceRecord) * 2 + 1];
+  static const char hex[] = "0123456789abcdef";
+  APP_LOG(APP_LOG_LEVEL_INFO, "TRACE-BEGIN %u", s_trace_count);
+  int first = (s_trace_next + TRACE_CAPACITY - s_trace_count) % TRACE_CAPACITY;
+  for (int i = 0; i < s_trace_count; i += TRACE_RECORDS_PER_LINE) {
+    char *out = line;
+    for (int r = i; r < s_trace_count && r < i + TRACE_RECORDS_PER_LINE; r++) {
+      const uint8_t *bytes = (const uint8_t *)&s_trace[(first + r) % TRACE_CAPACITY];
+      for (size_t b = 0; b < sizeof(TraceRecord); b++) {
+        *out++ = hex[bytes[b] >> 4];
+        *out++ = hex[bytes[b] & 0xF];
+      }
+    }
+    *out = '\0';
+    APP_LOG(APP_LOG_LEVEL_INFO, "TRACE %s", line);
+  }
+  APP_LOG(APP_LOG_LEVEL_INFO, "TRACE-END");
+}
+
+#define TRACE_BEGIN(event) trace_record(TRACE_PHASE_BEGIN, (event), 0)
+#define TRACE_END(event) trace_record(TRACE_PHASE_END, (event), 0)
+#define TRACE_INSTANT(event, arg) trace_record(TRACE_PHASE_INSTANT, (event), (arg))
+#else
+#define TRACE_BEGIN(event) ((void)0)
+#define TRACE_END(event) ((void)0)
+#define TRACE_INSTANT(event, arg) ((void)0)
+#endif
+
+// Flight recorder: always on, one 8-byte record per rendered frame in a RAM
+// ring. A hitch (a frame over FLIGHT_HITCH_MS) keeps recording for
+// FLIGHT_POST_HITCH_FRAMES more frames and then freezes the ring so the
+// frames around it survive; it is persisted when the run ends, never mid-run,
+// since flash writes would cause hitches of their own. A session in which
+// the watchdog had to shed work is persisted at unload. The flight screen
+// shows the last recording and dumps it over APP_LOG for
+// tools/decode_flight_recorder.py; keep the record layout in step with it.
+typedef enum {
+  FLIGHT_REASON_NONE,
+  FLIGHT_REASON_HITCH, // A frame went over FLIGHT_HITCH_MS
+  FLIGHT_REASON_SHED,  // The watchdog shed work during the session
+} FlightReason;
+
+// Input bits: buttons pressed since the previous record plus Pyoro's state
+#define FLIGHT_INPUT_UP 0x01
+#define FLIGHT_INPUT_SELECT 0x02
+#define FLIGHT_INPUT_DOWN 0x04
+#define FLIGHT_INPUT_HOLD 0x08
+#define FLIGHT_INPUT_TONGUE 0x10   // Tongue out
+#define FLIGHT_INPUT_STEPPING 0x20 // Steps queued
+#define FLIGHT_INPUT_DEAD 0x40
+
+typedef struct {
+  uint8_t update_ms; // Simulation ticks run this frame, saturated
+  uint8_t draw_ms;   // The previous draw, saturated
+  uint8_t beans;     // Active beans
+  uint8_t angels : 3;
+  uint8_t shed : 3;  // ShedLevel
+  uint8_t swarm : 1;
+  uint8_t reserved : 1;
+  uint16_t heap_free_4; // heap_bytes_free() / 4
+  uint8_t stage;     // Background index
+  uint8_t input;     // FLIGHT_INPUT_* bits
+} FlightRecord;
+_Static_assert(sizeof(FlightRecord) == 8, "flight records are 8 bytes on the wire");
+_Static_assert(FLIGHT_CAPACITY % FLIGHT_RECORDS_PER_KEY == 0, "flight keys are always full");
+_Static_assert(FLIGHT_PERSIST_RECORDS <= FLIGHT_CAPACITY, "only frames in the ring are persisted");
+_Static_assert(FLIGHT_POST_HITCH_FRAMES < FLIGHT_PERSIST_RECORDS, "the hitch frame is always persisted");
+
+// Persisted after the records, so a recording interrupted mid-write is ignored
+typedef struct {
+  uint8_t version;
+  uint8_t reason;     // FlightReason
+  uint16_t count;     // Records, oldest first
+  uint32_t timestamp; // Wall-clock time it was persisted
+  uint16_t hitch_ms;  // Cost of the hitch frame (FLIGHT_REASON_HITCH)
+  uint16_t hitch_age; // Records after the hitch one
+} FlightHeader;
+
+// Pebble allows an app 4 KB of persistent storage in total, and a full store
+// fails writes silently from then on. The codec stores a record raw when
+// packing doesn't shrink it, so the worst case is every record at its raw
+// size; the rest of the budget covers the store's per-key overhead.
+#define PERSIST_STORAGE_BUDGET 4096
+#define PERSIST_WORST_CASE_BYTES                                                   \
+  (NUM_HIGH_SCORES * sizeof(HighScoreEntry) + NUM_HIGH_SCORES +                   \
+   sizeof(LifetimeStats) + sizeof(FlightHeader) + FLIGHT_PERSIST_RECORDS * sizeof(FlightRecord) + \
+   sizeof(ReplayHeader) + REPLAY_PERSIST_MAX_EVENTS * 2 + REPLAY_PERSIST_MAX_CHECKPOINTS * 4 + \
+   sizeof(bool))
+_Static_assert(PERSIST_WORST_CASE_BYTES <= PERSIST_STORAGE_BUDGET * 7 / 8,
+               "persisted records must fit the app's storage with room for key overhead");
+
+static struct {
+  FlightRecord records[FLIGHT_CAPACITY];
+  uint16_t next;
+  uint16_t count;
+  uint16_t hitch_ms;
+  uint16_t post_hitch_frames; // Frames left to record before freezing
+  uint8_t reason;             // FlightReason waiting to be persisted
+  uint8_t input;              // FLIGHT_INPUT_* since the last record
+  bool previous_crashed;      // The last session never reached window unload
+  FlightHeader loaded;        // Header of the recording on the flight screen
+} s_flight;
+
+static struct {
+  ReplayHeader header;
+  uint16_t events[REPLAY_MAX_EVENTS];
+  uint32_t checkpoints[REPLAY_MAX_CHECKPOINTS];
+  uint32_t last_event_tick;
+  uint8_t last_input;     // ReplayInput of the last event, or the input a run repeats
+} s_replay;
+
+// Packed form of the record being read or written, and the byte planes of
+// a blob key around it
+static uint8_t s_persist_packed[PERSIST_DATA_MAX_LENGTH];
+static uint8_t s_persist_planes[PERSIST_DATA_MAX_LENGTH];
+
+// Write a record of at most PERSIST_DATA_MAX_LENGTH bytes, packed with the
+// codec when that makes it smaller. A stored size equal to the record's
+// means raw, so records written before the codec still read back. False
+// (and logged) if storage refused it.
+static bool persist_write_record(uint32_t key, const void *data, size_t size) {
+  int packed = codec_compress(data, size, s_persist_packed, size - 1);
+  int written = packed > 0 ? persist_write_data(key, s_persist_packed, packed) :
+                             persist_write_data(key, data, size);
+  if (written != (packed > 0 ? packed : (int)size)) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Persisting key %lu failed: %d", (unsigned long)key, written);
+    return false;
+  }
+  return true;
+}
+
+// Read back a record written by persist_write_record. False if it is
+// missing or damaged, in which case data may have been overwritten.
+static bool persist_read_record(uint32_t key, void *data, size_t size) {
+  int stored = persist_get_size(key);
+  if (stored == (int)size) {
+    return persist_read_data(key, data, size) == (int)size;
+  }
+  if (stored <= 0 || stored > (int)size) {
+    return false;
+  }
+  persist_read_data(key, s_persist_packed, stored);
+  return codec_decompress(s_persist_packed, stored, data, size) == (int)size;
+}
+
+// Split an array of stride-byte elements over records at *key onwards,
+// PERSIST_DATA_MAX_LENGTH bytes each, and advance *key past them. With a
+// stride above 1 each key holds the byte planes of its elements. False at
+// the first key storage refused.
+static bool persist_write_blob(uint32_t *key, const void *data, size_t size, size_t stride) {
+  const uint8_t *bytes = data;
+  for (size_t offset = 0; offset < size; offset += PERSIST_DATA_MAX_LENGTH) {
+    size_t n = size - offset < PERSIST_DATA_MAX_LENGTH ? size - offset : PERSIST_DATA_MAX_LENGTH;
+    if (stride > 1) {
+      codec_split_planes(bytes + offset, s_persist_planes, n, stride);
+    }
+    if (!persist_write_record((*key)++, stride > 1 ? s_persist_planes : bytes + offset, n)) {
       return false;
     }
   }
-  s_game.pyoro.x = new_x;
   return true;
 }
 
-// High scores (persistent)
-static void load_high_scores(void) {
-  for (int i = 0; i < NUM_HIGH_SCORES; i++) {
-    s_high_scores[i] = HIGH_SCORE_EMPTY;
+static bool persist_read_blob(uint32_t *key, void *data, size_t size, size_t stride) {
+  uint8_t *bytes = data;
+  for (size_t offset = 0; offset < size; offset += PERSIST_DATA_MAX_LENGTH) {
+    size_t n = size - offset < PERSIST_DATA_MAX_LENGTH ? size - offset : PERSIST_DATA_MAX_LENGTH;
+    if (!persist_read_record((*key)++, stride > 1 ? s_persist_planes : bytes + offset, n)) {
+      return false;
+    }
+    if (stride > 1) {
+      codec_merge_planes(s_persist_planes, bytes + offset, n, stride);
+    }
   }
-  if (persist_exists(PERSIST_KEY_HIGH_SCORES)) {
-    persist_read_data(PERSIST_KEY_HIGH_SCORES, s_high_scores,
-                      sizeof(s_high_scores));
+  return true;
+}
+
+// Hex-encode bytes over APP_LOG, LOG_HEX_BYTES_PER_LINE per line
+static void log_hex(const char *tag, const void *data, size_t size) {
+  static char line[LOG_HEX_BYTES_PER_LINE * 2 + 1];
+  static const char hex[] = "0123456789abcdef";
+  const uint8_t *bytes = data;
+  for (size_t i = 0; i < size; i += LOG_HEX_BYTES_PER_LINE) {
+    char *out = line;
+    for (size_t b = i; b < size && b < i + LOG_HEX_BYTES_PER_LINE; b++) {
+      *out++ = hex[bytes[b] >> 4];
+      *out++ = hex[bytes[b] & 0xF];
+    }
+    *out = '\0';
+    APP_LOG(APP_LOG_LEVEL_INFO, "%s %s", tag, line);
   }
 }
 
-static void save_high_scores(void) {
-  persist_write_data(PERSIST_KEY_HIGH_SCORES, s_high_scores,
-                    sizeof(s_high_scores));
+static void flight_record_frame(uint32_t update_ms) {
+  if (s_flight.reason == FLIGHT_REASON_HITCH && s_flight.post_hitch_frames == 0) {
+    return; // Frozen until persisted
+  }
+  int beans = 0;
+  for (int i = 0; i < MAX_BEANS; i++) {
+    beans += s_game.beans[i].active;
+  }
+  int angels = 0;
+  for (int i = 0; i < MAX_ANGELS; i++) {
+    angels += s_game.angels[i].active;
+  }
+  uint8_t input = s_flight.input;
+  input |= s_game.pyoro.tongue.active ? FLIGHT_INPUT_TONGUE : 0;
+  input |= s_game.pending_step_count ? FLIGHT_INPUT_STEPPING : 0;
+  input |= s_game.pyoro.dead ? FLIGHT_INPUT_DEAD : 0;
+  size_t heap_free = heap_bytes_free() / 4;
+  s_flight.records[s_flight.next] = (FlightRecord) {
+    .update_ms = update_ms > UINT8_MAX ? UINT8_MAX : update_ms,
+    .draw_ms = s_watchdog.last_draw_ms > UINT8_MAX ? UINT8_MAX : s_watchdog.last_draw_ms,
+    .beans = beans,
+    .angels = angels,
+    .shed = s_watchdog.level,
+    .swarm = s_game.swarm,
+    .heap_free_4 = heap_free > UINT16_MAX ? UINT16_MAX : heap_free,
+    .stage = s_game.background_index,
+    .input = input,
+  };
+  s_flight.next = (s_flight.next + 1) % FLIGHT_CAPACITY;
+  if (s_flight.count < FLIGHT_CAPACITY) {
+    s_flight.count++;
+  }
+  s_flight.input = 0;
+
+  uint32_t cost = update_ms + s_watchdog.last_draw_ms;
+  if (s_flight.reason == FLIGHT_REASON_HITCH) {
+    s_flight.post_hitch_frames--;
+  } else if (cost > FLIGHT_HITCH_MS) {
+    s_flight.reason = FLIGHT_REASON_HITCH;
+    s_flight.hitch_ms = cost > UINT16_MAX ? UINT16_MAX : cost;
+    s_flight.post_hitch_frames = FLIGHT_POST_HITCH_FRAMES;
+  } else if (s_watchdog.level > SHED_NONE) {
+    s_flight.reason = FLIGHT_REASON_SHED;
+  }
 }
 
-static void insert_high_score(int score) {
-  int insert_at = -1;
-  for (int i = 0; i < NUM_HIGH_SCORES; i++) {
-    if (s_high_scores[i] == HIGH_SCORE_EMPTY || score > s_high_scores[i]) {
-      insert_at = i;
-      break;
+// Write the newest FLIGHT_PERSIST_RECORDS of the ring oldest first,
+// FLIGHT_RECORDS_PER_KEY records per key, then the header, and start
+// recording again. Keys a longer recording left behind are freed.
+static void flight_persist(void) {
+  static FlightRecord chunk[FLIGHT_RECORDS_PER_KEY];
+  int count = s_flight.count < FLIGHT_PERSIST_RECORDS ? s_flight.count : FLIGHT_PERSIST_RECORDS;
+  int first = (s_flight.next + FLIGHT_CAPACITY - count) % FLIGHT_CAPACITY;
+  uint32_t key = PERSIST_KEY_FLIGHT_BASE;
+  bool written = true;
+  persist_delete(PERSIST_KEY_FLIGHT_HEADER);
+  for (int r = 0; r < count && written;) {
+    int n = 0;
+    for (; r < count && n < FLIGHT_RECORDS_PER_KEY; r++) {
+      chunk[n++] = s_flight.records[(first + r) % FLIGHT_CAPACITY];
     }
+    written = persist_write_blob(&key, chunk, n * sizeof(FlightRecord), sizeof(FlightRecord));
   }
-  if (insert_at < 0) {
-    return; // Not in top 10
+  for (; key < PERSIST_KEY_FLIGHT_BASE + FLIGHT_CAPACITY / FLIGHT_RECORDS_PER_KEY; key++) {
+    persist_delete(key);
   }
-  for (int i = NUM_HIGH_SCORES - 1; i > insert_at; i--) {
-    s_high_scores[i] = s_high_scores[i - 1];
+  FlightHeader header = {
+    .version = FLIGHT_VERSION,
+    .reason = s_flight.reason,
+    .count = count,
+    .timestamp = (uint32_t)time(NULL),
+    .hitch_ms = s_flight.reason == FLIGHT_REASON_HITCH ? s_flight.hitch_ms : 0,
+    .hitch_age = s_flight.reason == FLIGHT_REASON_HITCH ?
+                 FLIGHT_POST_HITCH_FRAMES - s_flight.post_hitch_frames : 0,
+  };
+  if (written) {
+    persist_write_record(PERSIST_KEY_FLIGHT_HEADER, &header, sizeof(header));
   }
-  s_high_scores[insert_at] = score;
-  save_high_scores();
+  s_flight.reason = FLIGHT_REASON_NONE;
+  s_flight.post_hitch_frames = 0;
 }
 
-// Initialize game
-static void init_game(void) {
-  s_game.state = GAME_STATE_MENU;
-  s_game.score = 0;
-  s_physics_speed = 1.0f;
-  s_game.game_speed = 1.0f;
-  s_game.bean_spawn_timer = 0.0f;
-  s_game.death_timer = 0.0f;
-  s_game.game_paused = false;
-  
-  // Initialize Pyoro
-  s_game.pyoro.x = GAME_WIDTH / 2.0f;
-  s_game.pyoro.y = GAME_HEIGHT - 2.0f;
-  s_game.pyoro.direction = 1;
-  s_game.pyoro.moving = false;
-  s_game.pyoro.dead = false;
-  s_game.pyoro.button_held = false;
-  s_game.pyoro.tongue.active = false;
-  
-  // Initialize blocks
-  for (int i = 0; i < GAME_WIDTH; i++) {
-    s_game.blocks[i].exists = true;
-    s_game.blocks[i].is_repairing = false;
+// Replace the ring with the persisted recording (oldest record at index 0).
+// Anything still waiting to be persisted is written first so it is the one shown.
+static bool flight_load(void) {
+  if (s_flight.reason != FLIGHT_REASON_NONE) {
+    flight_persist();
   }
-  
-  // Initialize beans
-  for (int i = 0; i < 5; i++) {
-    s_game.beans[i].active = false;
-    s_game.beans[i].type = BEAN_TYPE_GREEN;
+  memset(&s_flight.loaded, 0, sizeof(s_flight.loaded));
+  FlightHeader header;
+  if (!persist_read_record(PERSIST_KEY_FLIGHT_HEADER, &header, sizeof(header)) ||
+      header.version != FLIGHT_VERSION || header.count > FLIGHT_CAPACITY) {
+    return false;
   }
-  
-  // Initialize angel
-  s_game.angel.active = false;
+  uint32_t key = PERSIST_KEY_FLIGHT_BASE;
+  if (!persist_read_blob(&key, s_flight.records, header.count * sizeof(FlightRecord), sizeof(FlightRecord))) {
+    s_flight.count = 0;
+    s_flight.next = 0;
+    return false;
+  }
+  s_flight.loaded = header;
+  s_flight.count = header.count;
+  s_flight.next = header.count % FLIGHT_CAPACITY;
+  return true;
 }
 
-static void reset_game(void) {
-  init_game();
-  s_physics_speed = 1.0f;
-  s_game.game_speed = 1.0f;
-  s_game.state = GAME_STATE_PLAYING;
-  s_pending_step_dir = 0;
-  s_pending_step_count = 0;
-  // Reset background to first image for new game
-  s_background_index = 0;
-  if (s_background_bitmap) {
-    gbitmap_destroy(s_background_bitmap);
-    s_background_bitmap = NULL;
+// Log the loaded recording, oldest record first
+static void flight_dump(void) {
+  APP_LOG(APP_LOG_LEVEL_INFO, "FLIGHT-BEGIN %u %u %u %u %lu %u", s_flight.loaded.reason,
+          s_flight.loaded.count, s_flight.loaded.hitch_ms, s_flight.loaded.hitch_age,
+          (unsigned long)s_flight.loaded.timestamp, s_flight.previous_crashed);
+  log_hex("FLIGHT", s_flight.records, s_flight.loaded.count * sizeof(FlightRecord));
+  APP_LOG(APP_LOG_LEVEL_INFO, "FLIGHT-END");
+}
+
+// Simulation PRNG (xorshift32). Its state lives in Game, so the seed alone
+// reproduces a run on the watch and in the host tools alike.
+static void game_srand(uint32_t seed) {
+  s_game.rng = seed ? seed : 1;
+}
+
+static uint32_t game_rand(void) {
+  uint32_t x = s_game.rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  s_game.rng = x;
+  return x;
+}
+
+static uint32_t hash_word(uint32_t hash, uint32_t word) {
+  for (int i = 0; i < 4; i++) {
+    hash = (hash ^ (word & 0xFF)) * 16777619u; // FNV-1a
+    word >>= 8;
   }
-  s_background_bitmap = gbitmap_create_with_resource(s_background_resource_ids[0]);
-  layer_mark_dirty(s_game_layer);
+  return hash;
 }
 
-// Find a destroyed block that can be repaired
-static int find_destroyed_block(void) {
-  for (int i = 0; i < GAME_WIDTH; i++) {
-    if (!s_game.blocks[i].exists && !s_game.blocks[i].is_repairing) {
-      return i;
+static uint32_t hash_float(uint32_t hash, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return hash_word(hash, bits);
+}
+
+// Hash of everything the simulation carries from one tick to the next,
+// field by field so struct padding and compiler layout never matter
+static uint32_t game_state_hash(const Game *game) {
+  const Pyoro *pyoro = &game->pyoro;
+  uint32_t hash = 2166136261u;
+  hash = hash_word(hash, (uint16_t)pyoro->x | (uint32_t)(uint16_t)pyoro->y << 16);
+  hash = hash_word(hash, (uint8_t)pyoro->direction | pyoro->dead << 8 | pyoro->moving << 9);
+  hash = hash_word(hash, (uint16_t)pyoro->tongue.ext | (uint32_t)(uint16_t)pyoro->tongue.start_x << 16);
+  hash = hash_word(hash, (uint16_t)pyoro->tongue.start_y | (uint32_t)(uint8_t)pyoro->tongue.direction << 16 |
+                         pyoro->tongue.active << 24 | pyoro->tongue.going_back << 25 |
+                         pyoro->tongue.caught_bean << 26);
+  for (int i = 0; i < MAX_BEANS; i++) {
+    const Bean *bean = &game->beans[i];
+    if (bean->active) {
+      hash = hash_word(hash, i | bean->caught << 8 | bean->type << 9 | (uint32_t)bean->speed << 16);
+      hash = hash_word(hash, (uint16_t)bean->x | (uint32_t)(uint16_t)bean->y << 16);
     }
   }
-  return -1;
+  for (int i = 0; i < MAX_ANGELS; i++) {
+    const Angel *angel = &game->angels[i];
+    if (angel->active) {
+      hash = hash_word(hash, i | (uint8_t)angel->target_block_index << 8 | angel->going_up << 16);
+      hash = hash_word(hash, (uint16_t)angel->x | (uint32_t)(uint16_t)angel->y << 16);
+    }
+  }
+  hash = hash_word(hash, game->blocks);
+  hash = hash_word(hash, game->blocks_repairing);
+  hash = hash_word(hash, game->score);
+  hash = hash_word(hash, game->ticks);
+  hash = hash_word(hash, game->rng);
+  hash = hash_float(hash, game->speed);
+  hash = hash_float(hash, game->bean_spawn_timer);
+  hash = hash_word(hash, (uint8_t)game->pending_step_dir | game->pending_step_count << 8 |
+                         game->background_index << 16);
+  if (game->waves) {
+    const WaveState *wave = &game->wave;
+    hash = hash_word(hash, wave->pc | (uint32_t)wave->wait << 16);
+    hash = hash_word(hash, wave->depth | wave->running << 2);
+    for (int i = 0; i < wave->depth; i++) {
+      hash = hash_word(hash, wave->loop_start[i] | (uint32_t)wave->loop_left[i] << 16);
+    }
+  }
+  return hash;
 }
 
-// Spawn a new bean
-static void spawn_bean(void) {
-  for (int i = 0; i < 5; i++) {
-    if (!s_game.beans[i].active) {
-      s_game.beans[i].x = (rand() % GAME_WIDTH) + 0.5f;
-      s_game.beans[i].y = 0.0f;
-      s_game.beans[i].speed = (rand() % 100) / 100.0f * 1.0f + 0.5f;
-      s_game.beans[i].active = true;
-      s_game.beans[i].caught = false;
-      
-      // Check if we should spawn a pink bean (only if there's a destroyed block)
-      int destroyed_block = find_destroyed_block();
-      if (destroyed_block >= 0 && (rand() % 5) < 2) {
-        // 40% chance to spawn pink bean if blocks are destroyed
-        s_game.beans[i].type = BEAN_TYPE_PINK;
-      } else {
-        s_game.beans[i].type = BEAN_TYPE_GREEN;
-      }
-      break;
+static void replay_reset(void) {
+  memset(&s_replay.header, 0, sizeof(s_replay.header));
+  s_replay.last_event_tick = 0;
+  s_replay.last_input = REPLAY_INPUT_NONE;
+}
+
+static bool replay_push_event(uint32_t delta, ReplayInput input) {
+  if (s_replay.header.event_count >= REPLAY_MAX_EVENTS) {
+    s_replay.header.flags |= REPLAY_FLAG_TRUNCATED;
+    return false;
+  }
+  s_replay.events[s_replay.header.event_count++] = delta << REPLAY_EVENT_INPUT_BITS | input;
+  return true;
+}
+
+// Fold a held button's repeat into the run event after the previous one,
+// opening a new run when there is none or it is full. False if the repeat
+// doesn't follow its own kind closely enough to join a run.
+static bool replay_extend_run(uint32_t delta, ReplayInput input) {
+  if ((input != REPLAY_INPUT_UP_REPEAT && input != REPLAY_INPUT_DOWN_REPEAT) || input != s_replay.last_input ||
+      delta < REPLAY_RUN_MIN_DELTA || delta > REPLAY_RUN_MIN_DELTA + 3) {
+    return false;
+  }
+  uint16_t *last = &s_replay.events[s_replay.header.event_count - 1];
+  uint32_t count = (*last & REPLAY_EVENT_INPUT_MASK) == REPLAY_INPUT_REPEAT_RUN ?
+      (*last >> REPLAY_EVENT_INPUT_BITS) & 7 : REPLAY_RUN_MAX;
+  if (count < REPLAY_RUN_MAX) {
+    *last += 1 << REPLAY_EVENT_INPUT_BITS;
+    *last |= (delta - REPLAY_RUN_MIN_DELTA) << (REPLAY_RUN_DELTA_SHIFT + 2 * count);
+    return true;
+  }
+  return replay_push_event(1 | (delta - REPLAY_RUN_MIN_DELTA) << (REPLAY_RUN_DELTA_SHIFT - REPLAY_EVENT_INPUT_BITS),
+                           REPLAY_INPUT_REPEAT_RUN);
+}
+
+// Record an input that changed the simulation; it takes effect before the
+// tick numbered s_game.ticks
+static void replay_record_input(ReplayInput input) {
+  if (s_replay.header.flags & REPLAY_FLAG_TRUNCATED) {
+    return;
+  }
+  uint32_t delta = s_game.ticks - s_replay.last_event_tick;
+  if (replay_extend_run(delta, input)) {
+    s_replay.last_event_tick = s_game.ticks;
+    return;
+  }
+  while (delta > REPLAY_EVENT_MAX_DELTA) {
+    if (!replay_push_event(REPLAY_EVENT_MAX_DELTA, REPLAY_INPUT_NONE)) {
+      return;
     }
+    delta -= REPLAY_EVENT_MAX_DELTA;
+  }
+  if (replay_push_event(delta, input)) {
+    s_replay.last_event_tick = s_game.ticks;
+    s_replay.last_input = input;
   }
 }
 
-// Spawn an angel to repair a block
-static void spawn_angel(int block_index) {
-  if (block_index < 0 || block_index >= GAME_WIDTH) {
+// Called at the start of every live tick, after that tick's inputs
+static void replay_checkpoint(void) {
+  if (s_game.ticks % REPLAY_CHECKPOINT_TICKS != 0 ||
+      s_replay.header.checkpoint_count >= REPLAY_MAX_CHECKPOINTS) {
     return;
   }
-  if (s_game.blocks[block_index].exists || s_game.blocks[block_index].is_repairing) {
+  s_replay.checkpoints[s_replay.header.checkpoint_count++] = game_state_hash(&s_game);
+}
+
+// Fill in the header from the finished run
+static void replay_finish(void) {
+  ReplayHeader *header = &s_replay.header;
+  header->magic[0] = 'P';
+  header->magic[1] = 'R';
+  header->version = REPLAY_VERSION;
+  header->flags = (header->flags & REPLAY_FLAG_TRUNCATED) | (s_game.swarm ? REPLAY_FLAG_SWARM : 0) |
+                  (s_game.waves ? REPLAY_FLAG_WAVES : 0);
+  header->seed = s_game.seed;
+  header->ticks = s_game.ticks;
+  header->score = s_game.score;
+  header->checkpoint_interval = REPLAY_CHECKPOINT_TICKS;
+}
+
+// Log the replay file
+static void replay_dump(void) {
+  const ReplayHeader *header = &s_replay.header;
+  APP_LOG(APP_LOG_LEVEL_INFO, "REPLAY-BEGIN %lu %ld", (unsigned long)header->seed, (long)header->score);
+  log_hex("REPLAY", header, sizeof(*header));
+  log_hex("REPLAY", s_replay.events, header->event_count * sizeof(uint16_t));
+  log_hex("REPLAY", s_replay.checkpoints, header->checkpoint_count * sizeof(uint32_t));
+  APP_LOG(APP_LOG_LEVEL_INFO, "REPLAY-END");
+}
+
+// Keep the finished run as the best one, truncated to the storage budget.
+// The header goes last so a body interrupted mid-write is never paired with
+// it, and keys left over from a longer best run are freed. If storage
+// refuses any of it the whole replay is dropped, so it never holds space the
+// leaderboard and stats need.
+static void replay_save_best(void) {
+  ReplayHeader header = s_replay.header;
+  if (header.event_count > REPLAY_PERSIST_MAX_EVENTS) {
+    header.event_count = REPLAY_PERSIST_MAX_EVENTS;
+    header.flags |= REPLAY_FLAG_TRUNCATED;
+  }
+  if (header.checkpoint_count > REPLAY_PERSIST_MAX_CHECKPOINTS) {
+    header.checkpoint_count = REPLAY_PERSIST_MAX_CHECKPOINTS;
+  }
+  persist_delete(PERSIST_KEY_BEST_REPLAY_HEADER);
+  uint32_t key = PERSIST_KEY_BEST_REPLAY_BASE;
+  bool written =
+      persist_write_blob(&key, s_replay.events, header.event_count * sizeof(uint16_t), sizeof(uint16_t)) &&
+      // State hashes are noise to the codec, so they are stored as they are
+      persist_write_blob(&key, s_replay.checkpoints, header.checkpoint_count * sizeof(uint32_t), 1);
+  if (!written) {
+    key = PERSIST_KEY_BEST_REPLAY_BASE;
+  }
+  for (; key < PERSIST_KEY_BEST_REPLAY_BASE + REPLAY_PERSIST_MAX_KEYS; key++) {
+    persist_delete(key);
+  }
+  if (written) {
+    persist_write_record(PERSIST_KEY_BEST_REPLAY_HEADER, &header, sizeof(header));
+  }
+}
+
+// Replace the current replay with the best run's. Only valid outside a run.
+static bool replay_load_best(void) {
+  ReplayHeader *header = &s_replay.header;
+  uint32_t key = PERSIST_KEY_BEST_REPLAY_BASE;
+  bool loaded = persist_read_record(PERSIST_KEY_BEST_REPLAY_HEADER, header, sizeof(*header)) &&
+                header->version == REPLAY_VERSION && header->event_count <= REPLAY_MAX_EVENTS &&
+                header->checkpoint_count <= REPLAY_MAX_CHECKPOINTS &&
+                persist_read_blob(&key, s_replay.events, header->event_count * sizeof(uint16_t),
+                                  sizeof(uint16_t)) &&
+                persist_read_blob(&key, s_replay.checkpoints, header->checkpoint_count * sizeof(uint32_t), 1);
+  if (!loaded) {
+    replay_reset();
+  }
+  return loaded;
+}
+
+// Mark framebuffer rows [top, bottom) of the static scene for repainting
+static void invalidate_scene_rows(int top, int bottom) {
+  if (s_scene_dirty_top >= s_scene_dirty_bottom) {
+    s_scene_dirty_top = top;
+    s_scene_dirty_bottom = bottom;
     return;
   }
-  if (s_game.angel.active) {
-    return; // Only one angel at a time
+  if (top < s_scene_dirty_top) {
+    s_scene_dirty_top = top;
+  }
+  if (bottom > s_scene_dirty_bottom) {
+    s_scene_dirty_bottom = bottom;
   }
-  
-  s_game.angel.active = true;
-  s_game.angel.x = block_index + 0.5f;
-  s_game.angel.y = 0.0f;
-  s_game.angel.target_block_index = block_index;
-  s_game.angel.going_up = false;
-  s_game.blocks[block_index].is_repairing = true;
 }
 
-// Collision detection
-static bool check_collision(float x1, float y1, float w1, float h1,
-                            float x2, float y2, float w2, float h2) {
-  return (x1 - w1/2 < x2 + w2/2) &&
-         (x1 + w1/2 > x2 - w2/2) &&
-         (y1 - h1/2 < y2 + h2/2) &&
-         (y1 + h1/2 > y2 - h2/2);
+static void invalidate_scene(void) {
+  invalidate_scene_rows(0, INT16_MAX);
 }
 
-// Update game logic
-static void update_game(float delta_time) {
-  if (s_game.state != GAME_STATE_PLAYING || s_game.game_paused) {
+static void invalidate_block_row(void) {
+  GRect row = s_layout.block_rects[0];
+  invalidate_scene_rows(row.origin.y, row.origin.y + row.size.h);
+}
+
+#if BACKGROUND_DECODED
+// Decode a run-length encoded background resource into the fixed bitmap
+static void decode_background(uint32_t resource_id) {
+  uint8_t *dst = gbitmap_get_data(s_background_bitmap);
+  int stride = gbitmap_get_bytes_per_row(s_background_bitmap);
+  ResHandle handle = resource_get_handle(resource_id);
+  uint8_t header[BG_ROWS_HEADER_SIZE];
+  if (resource_load_byte_range(handle, 0, header, sizeof(header)) != sizeof(header) ||
+      header[0] != 'B' || header[1] != 'R' || header[2] != 8 || !(header[3] & BG_FLAG_RLE) ||
+      (header[4] | (header[5] << 8)) != BG_DECODED_WIDTH ||
+      (header[6] | (header[7] << 8)) != BG_DECODED_HEIGHT) {
+    memset(dst, GColorBlackARGB8, stride * BG_DECODED_HEIGHT);
     return;
   }
-  
-  // Handle death timer
-  if (s_game.pyoro.dead) {
-    s_game.death_timer -= delta_time;
-    if (s_game.death_timer <= 0.0f) {
-      s_last_game_score = s_game.score;
-      insert_high_score(s_game.score);
-      s_game.state = GAME_STATE_GAME_OVER;
-      if (s_game_timer) {
-        app_timer_cancel(s_game_timer);
-        s_game_timer = NULL;
+  size_t size = resource_size(handle);
+  size_t offset = BG_ROWS_HEADER_SIZE;
+  int x = 0;
+  int y = 0;
+  while (offset < size && y < BG_DECODED_HEIGHT) {
+    size_t bytes = size - offset < BG_RLE_CHUNK_BYTES ? size - offset : BG_RLE_CHUNK_BYTES;
+    bytes = resource_load_byte_range(handle, offset, s_background_chunk, bytes) & ~1u;
+    if (bytes == 0) {
+      break;
+    }
+    offset += bytes;
+    for (size_t i = 0; i < bytes && y < BG_DECODED_HEIGHT; i += 2) {
+      int count = s_background_chunk[i];
+      uint8_t color = s_background_chunk[i + 1];
+      while (count > 0 && y < BG_DECODED_HEIGHT) {
+        int span = BG_DECODED_WIDTH - x < count ? BG_DECODED_WIDTH - x : count;
+        memset(dst + y * stride + x, color, span);
+        x += span;
+        count -= span;
+        if (x == BG_DECODED_WIDTH) {
+          x = 0;
+          y++;
+        }
       }
     }
-    // Don't update game logic while dead, but keep rendering
-    layer_mark_dirty(s_game_layer);
+  }
+}
+#endif
+
+// Switch the stage background and repaint the whole scene. The resource is
+// only reloaded when the index actually changes (a retry stays on stage 0).
+static void set_background(int index) {
+  s_game.background_index = index;
+  invalidate_scene();
+  if (index == s_loaded_background) {
+#if PROCEDURAL_SKY
+    s_sky_position = index << 8;
+#endif
     return;
   }
-  
-  float dt = delta_time * s_physics_speed;
-  s_physics_speed += dt * SPEED_ACCELERATION;
-  s_game.game_speed = s_physics_speed;
-  
-  // Update Pyoro movement:
-  if (s_game.pyoro.tongue.active) {
-    s_pending_step_count = 0;
-    s_pending_step_dir = 0;
-  } else if (s_pending_step_count > 0 && s_pending_step_dir != 0) {
-    apply_pyoro_step(s_pending_step_dir);
-    s_pending_step_count--;
-    if (s_pending_step_count <= 0) {
-      s_pending_step_dir = 0;
+  s_loaded_background = index;
+#if PROCEDURAL_SKY
+  s_sky_position = index << 8;
+#elif BACKGROUND_STREAMED
+  s_background_rows = resource_get_handle(s_background_resource_ids[index]);
+  uint8_t header[BG_ROWS_HEADER_SIZE];
+  s_background_rows_width = 0;
+  s_background_rows_height = 0;
+  if (resource_load_byte_range(s_background_rows, 0, header, sizeof(header)) == sizeof(header) &&
+      header[0] == 'B' && header[1] == 'R' && header[2] == 1) {
+    uint16_t width = header[4] | (header[5] << 8);
+    if ((width + 7) / 8 <= BG_ROWS_MAX_ROW_BYTES) {
+      s_background_rows_width = width;
+      s_background_rows_height = header[6] | (header[7] << 8);
     }
   }
-  
-  // Increment frame counter
-  s_frame_count++;
-  
-  // (Legacy moving/button_held no longer used for horizontal movement)
-  
-  // Update tongue
-  if (s_game.pyoro.tongue.active) {
-    if (s_game.pyoro.tongue.going_back) {
-      // Tongue retracting
-      float retract_speed = TONGUE_SPEED * 2.0f * dt;
-      s_game.pyoro.tongue.x -= s_game.pyoro.tongue.direction * retract_speed;
-      s_game.pyoro.tongue.y += retract_speed;
-      
-      if (s_game.pyoro.tongue.caught_bean) {
-        // Move caught bean with tongue
-        for (int i = 0; i < 5; i++) {
-          if (s_game.beans[i].active && s_game.beans[i].caught) {
-            s_game.beans[i].x = s_game.pyoro.tongue.x;
-            s_game.beans[i].y = s_game.pyoro.tongue.y;
-            break;
-          }
-        }
-      }
-      
-      // Check if tongue is back
-      if (s_game.pyoro.tongue.y >= s_game.pyoro.y) {
-        if (s_game.pyoro.tongue.caught_bean) {
-          // Find the caught bean and check its type
-          BeanType caught_bean_type = BEAN_TYPE_GREEN;
-          for (int i = 0; i < 5; i++) {
-            if (s_game.beans[i].active && s_game.beans[i].caught) {
-              caught_bean_type = s_game.beans[i].type;
-              
-              // If it's a pink bean, spawn an angel to repair a block
-              if (caught_bean_type == BEAN_TYPE_PINK) {
-                int destroyed_block = find_destroyed_block();
-                if (destroyed_block >= 0) {
-                  spawn_angel(destroyed_block);
-                }
-              }
-              
-              // Calculate score based on height
-              int score_add = 10;
-              if (s_game.pyoro.tongue.y < GAME_HEIGHT * 0.2f) {
-                score_add = 1000;
-              } else if (s_game.pyoro.tongue.y < GAME_HEIGHT * 0.4f) {
-                score_add = 300;
-              } else if (s_game.pyoro.tongue.y < GAME_HEIGHT * 0.6f) {
-                score_add = 100;
-              } else if (s_game.pyoro.tongue.y < GAME_HEIGHT * 0.8f) {
-                score_add = 50;
-              }
-              s_game.score += score_add;
-              
-              // Remove caught bean
-              s_game.beans[i].active = false;
-              break;
-            }
-          }
-        }
-        s_game.pyoro.tongue.active = false;
+#else
+  if (s_background_bitmap) {
+    decode_background(s_background_resource_ids[index]);
+  }
+#endif
+}
+
+static inline bool block_exists(int index) {
+  return (s_game.blocks >> index) & 1;
+}
+
+static void rebuild_support_map(void) {
+  int run_start = -1;
+  for (int i = 0; i <= GAME_WIDTH; i++) {
+    bool exists = i < GAME_WIDTH && block_exists(i);
+    if (exists) {
+      if (run_start < 0) {
+        run_start = i;
       }
-    } else {
-      // Tongue extending
-      float extend_speed = TONGUE_SPEED * dt;
-      s_game.pyoro.tongue.x += s_game.pyoro.tongue.direction * extend_speed;
-      s_game.pyoro.tongue.y -= extend_speed;
-      
-      // Check for bean collision
-      for (int i = 0; i < 5; i++) {
-        if (s_game.beans[i].active && !s_game.beans[i].caught) {
-          if (check_collision(s_game.pyoro.tongue.x, s_game.pyoro.tongue.y,
-                             TONGUE_WIDTH, TONGUE_WIDTH,
-                             s_game.beans[i].x, s_game.beans[i].y,
-                             BEAN_SIZE, BEAN_SIZE)) {
-            s_game.beans[i].caught = true;
-            s_game.pyoro.tongue.caught_bean = true;
-            s_game.pyoro.tongue.going_back = true;
-            break;
-          }
-        }
+      continue;
+    }
+    if (run_start >= 0) {
+      for (int j = run_start; j < i; j++) {
+        s_walk_left[j] = run_start;
+        s_walk_right[j] = i - 1;
+      }
+      run_start = -1;
+    }
+    if (i < GAME_WIDTH) {
+      s_walk_left[i] = -1;
+      s_walk_right[i] = -1;
+    }
+  }
+}
+
+static void rebuild_bean_columns(void) {
+  memset(s_bean_columns, 0, sizeof(s_bean_columns));
+  for (int i = 0; i < MAX_BEANS; i++) {
+    const Bean *bean = &s_game.beans[i];
+    int column = bean->x >> FX_SHIFT;
+    if (bean->active && !bean->caught && column >= 0 && column < GAME_WIDTH) {
+      s_bean_columns[column] |= 1ull << i;
+    }
+  }
+}
+
+// Beans whose centre lies within reach of a box of width w centred on x:
+// the only candidates for overlapping it
+static uint64_t beans_near(int x, int w) {
+  int reach = (w + (BEAN_SIZE << FX_SHIFT)) / 2;
+  int first = (x - reach) >> FX_SHIFT;
+  int last = (x + reach) >> FX_SHIFT;
+  if (first < 0) {
+    first = 0;
+  }
+  if (last >= GAME_WIDTH) {
+    last = GAME_WIDTH - 1;
+  }
+  uint64_t near = 0;
+  for (int column = first; column <= last; column++) {
+    near |= s_bean_columns[column];
+  }
+  return near;
+}
+
+// Leftmost and rightmost x Pyoro can reach from x without stepping over a
+// hole (its whole body stays on the run of blocks under its centre). O(1).
+// Returns false if the column under Pyoro's centre is itself a hole.
+static bool pyoro_reach_bounds(int x, int *min_x, int *max_x) {
+  int column = x >> FX_SHIFT;
+  if (column < 0) {
+    column = 0;
+  } else if (column >= GAME_WIDTH) {
+    column = GAME_WIDTH - 1;
+  }
+  if (s_walk_left[column] < 0) {
+    return false;
+  }
+  *min_x = (s_walk_left[column] << FX_SHIFT) + (PYORO_SIZE << FX_SHIFT) / 2;
+  *max_x = ((s_walk_right[column] + 1) << FX_SHIFT) - (PYORO_SIZE << FX_SHIFT) / 2;
+  return true;
+}
+
+// Apply one horizontal step for Pyoro (used by step queue). Returns true if moved.
+// Step size scales with s_game.speed so Pyoro moves faster as the game progresses.
+// The step is clamped to the reachable interval, so Pyoro stops flush against a
+// hole or wall; an edge Pyoro already overhangs never pushes it backwards.
+static bool apply_pyoro_step(int step_dir) {
+  int min_x, max_x;
+  int x = s_game.pyoro.x;
+  if (!pyoro_reach_bounds(x, &min_x, &max_x)) {
+    return false;
+  }
+  int new_x = x + step_dir * TO_FX_ROUND(PYORO_SINGLE_STEP * s_game.speed);
+  if (new_x < min_x) {
+    new_x = min_x < x ? min_x : x;
+  } else if (new_x > max_x) {
+    new_x = max_x > x ? max_x : x;
+  }
+  s_game.pyoro.x = new_x;
+  return new_x != x;
+}
+
+// High scores (persistent)
+static void write_high_score_slot(int rank) {
+  persist_write_record(PERSIST_KEY_HIGH_SCORE_SLOT_BASE + s_high_score_slots[rank],
+                       &s_high_scores[rank], sizeof(HighScoreEntry));
+}
+
+static void write_high_score_order(void) {
+  persist_write_record(PERSIST_KEY_HIGH_SCORE_ORDER, s_high_score_slots,
+                       sizeof(s_high_score_slots));
+}
+
+// Import the old top-10 score table, which had no metadata
+static void migrate_legacy_high_scores(void) {
+  int legacy[LEGACY_NUM_HIGH_SCORES];
+  persist_read_data(PERSIST_KEY_HIGH_SCORES, legacy, sizeof(legacy));
+  for (int i = 0; i < LEGACY_NUM_HIGH_SCORES; i++) {
+    s_high_scores[i].score = legacy[i];
+    write_high_score_slot(i);
+  }
+  write_high_score_order();
+  persist_delete(PERSIST_KEY_HIGH_SCORES);
+}
+
+// True if the order table names every slot exactly once
+static bool high_score_order_valid(void) {
+  uint64_t seen = 0;
+  for (int i = 0; i < NUM_HIGH_SCORES; i++) {
+    uint8_t slot = s_high_score_slots[i];
+    if (slot >= NUM_HIGH_SCORES || (seen >> slot) & 1) {
+      return false;
+    }
+    seen |= 1ull << slot;
+  }
+  return true;
+}
+
+// Rebuild a lost order table: take the slots as they are and sort the rows
+// by score (insertion sort; ties keep slot order), then store the new order
+static void repair_high_score_order(void) {
+  for (int i = 0; i < NUM_HIGH_SCORES; i++) {
+    s_high_score_slots[i] = i;
+  }
+  for (int i = 1; i < NUM_HIGH_SCORES; i++) {
+    HighScoreEntry entry = s_high_scores[i];
+    uint8_t slot = s_high_score_slots[i];
+    int j = i;
+    for (; j > 0 && s_high_scores[j - 1].score < entry.score; j--) {
+      s_high_scores[j] = s_high_scores[j - 1];
+      s_high_score_slots[j] = s_high_score_slots[j - 1];
+    }
+    s_high_scores[j] = entry;
+    s_high_score_slots[j] = slot;
+  }
+  write_high_score_order();
+}
+
+static void load_high_scores(void) {
+  memset(s_high_scores, 0, sizeof(s_high_scores));
+  for (int i = 0; i < NUM_HIGH_SCORES; i++) {
+    s_high_scores[i].score = HIGH_SCORE_EMPTY;
+    s_high_score_slots[i] = i;
+  }
+  bool have_order = persist_read_record(PERSIST_KEY_HIGH_SCORE_ORDER, s_high_score_slots,
+                                        sizeof(s_high_score_slots));
+  bool order_valid = have_order && high_score_order_valid();
+  if (have_order && !order_valid) {
+    // Corrupt or from another layout: its indices can't be trusted to stay
+    // inside the slot table, so read the slots in their own order instead
+    APP_LOG(APP_LOG_LEVEL_WARNING, "High score order table invalid; rebuilding it");
+    for (int i = 0; i < NUM_HIGH_SCORES; i++) {
+      s_high_score_slots[i] = i;
+    }
+  }
+  if (have_order) {
+    for (int i = 0; i < NUM_HIGH_SCORES; i++) {
+      uint32_t key = PERSIST_KEY_HIGH_SCORE_SLOT_BASE + s_high_score_slots[i];
+      if (persist_exists(key) && !persist_read_record(key, &s_high_scores[i], sizeof(HighScoreEntry))) {
+        memset(&s_high_scores[i], 0, sizeof(HighScoreEntry));
+        s_high_scores[i].score = HIGH_SCORE_EMPTY;
+      }
+    }
+    if (!order_valid) {
+      repair_high_score_order();
+    }
+  } else if (persist_exists(PERSIST_KEY_HIGH_SCORES)) {
+    migrate_legacy_high_scores();
+  }
+}
+
+// Insert a finished run into the leaderboard. Returns its rank, or -1 if it
+// didn't place. Binary search finds the rank (ties go below existing rows),
+// the tail shifts down by one with memmove, and the evicted last row's slot
+// is reused for the new entry so only that slot and the order table are
+// persisted regardless of the leaderboard size.
+static int insert_high_score(const HighScoreEntry *entry) {
+  int lo = 0;
+  int hi = NUM_HIGH_SCORES;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (s_high_scores[mid].score >= entry->score) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo >= NUM_HIGH_SCORES) {
+    return -1; // Not on the leaderboard
+  }
+  int rank = lo;
+  uint8_t slot = s_high_score_slots[NUM_HIGH_SCORES - 1];
+  int tail = NUM_HIGH_SCORES - 1 - rank;
+  memmove(&s_high_scores[rank + 1], &s_high_scores[rank], tail * sizeof(s_high_scores[0]));
+  memmove(&s_high_score_slots[rank + 1], &s_high_score_slots[rank], tail * sizeof(s_high_score_slots[0]));
+  s_high_scores[rank] = *entry;
+  s_high_score_slots[rank] = slot;
+  write_high_score_slot(rank);
+  write_high_score_order();
+  return rank;
+}
+
+// Format the game-over leaderboard rows. The last run's row is highlighted by
+// its stored rank, so duplicate scores from older runs are never lit up; a run
+// ranked below the visible rows takes over the last visible line.
+static void build_game_over_overlay(void) {
+  snprintf(s_overlay_score_buf, sizeof(s_overlay_score_buf), "Your score: %d", s_last_game_score);
+  s_overlay_highlight_line = -1;
+  for (int i = 0; i < HIGH_SCORES_SHOWN; i++) {
+    int rank = i;
+    if (i == HIGH_SCORES_SHOWN - 1 && s_last_game_rank >= HIGH_SCORES_SHOWN) {
+      rank = s_last_game_rank;
+    }
+    if (s_high_scores[rank].score == HIGH_SCORE_EMPTY) {
+      snprintf(s_overlay_lines[i], sizeof(s_overlay_lines[i]), "%2d. ---", rank + 1);
+    } else {
+      snprintf(s_overlay_lines[i], sizeof(s_overlay_lines[i]), "%2d. %ld", rank + 1,
+               (long)s_high_scores[rank].score);
+    }
+    if (rank == s_last_game_rank) {
+      s_overlay_highlight_line = i;
+    }
+  }
+  s_overlay_dirty = false;
+}
+
+// Lifetime stats (persistent)
+static void load_lifetime_stats(void) {
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats.best_score = HIGH_SCORE_EMPTY;
+  if (!persist_read_record(PERSIST_KEY_LIFETIME_STATS, &s_stats, sizeof(s_stats))) {
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.best_score = HIGH_SCORE_EMPTY;
+  }
+}
+
+static void save_lifetime_stats(void) {
+  persist_write_record(PERSIST_KEY_LIFETIME_STATS, &s_stats, sizeof(s_stats));
+}
+
+// Index of the highest set bit plus one (0 for 0), clamped to the bucket count.
+static int log2_bucket(uint32_t value, int num_buckets) {
+  int bucket = value ? 32 - __builtin_clz(value) : 0;
+  return bucket < num_buckets ? bucket : num_buckets - 1;
+}
+
+// Height band of a tongue tip, 0 (10 points) at the bottom to 4 (1000) at the top
+static int catch_band(int tip_y) {
+  if (tip_y < TO_FX(GAME_HEIGHT * 0.2f)) {
+    return 4;
+  } else if (tip_y < TO_FX(GAME_HEIGHT * 0.4f)) {
+    return 3;
+  } else if (tip_y < TO_FX(GAME_HEIGHT * 0.6f)) {
+    return 2;
+  } else if (tip_y < TO_FX(GAME_HEIGHT * 0.8f)) {
+    return 1;
+  }
+  return 0;
+}
+
+static void stats_record_catch(int band) {
+  if (s_game.benchmark || s_game.swarm || s_game.waves) {
+    return;
+  }
+  s_stats.catches[band]++;
+}
+
+static void stats_record_block_lost(void) {
+  if (s_game.benchmark || s_game.swarm || s_game.waves) {
+    return;
+  }
+  s_stats.total_blocks_lost++;
+}
+
+static void stats_record_game(int score, float run_time) {
+  if (s_game.swarm || s_game.waves) {
+    return;
+  }
+  uint32_t seconds = (uint32_t)run_time;
+  s_stats.games_played++;
+  s_stats.total_score += score;
+  s_stats.total_play_seconds += seconds;
+  if (score > s_stats.best_score) {
+    s_stats.best_score = score;
+  }
+  uint16_t *score_slot = &s_stats.score_histogram[log2_bucket(score / 10, STATS_SCORE_BUCKETS)];
+  if (*score_slot < UINT16_MAX) {
+    (*score_slot)++;
+  }
+  uint16_t *survival_slot = &s_stats.survival_histogram[log2_bucket(seconds, STATS_SURVIVAL_BUCKETS)];
+  if (*survival_slot < UINT16_MAX) {
+    (*survival_slot)++;
+  }
+  save_lifetime_stats();
+}
+
+// Initialize game
+static void init_game(void) {
+  // Zero everything, padding included, so snapshots hash identically
+  int background_index = s_game.background_index;
+  memset(&s_game, 0, sizeof(s_game));
+  s_game.state = GAME_STATE_MENU;
+  s_game.speed = 1.0f;
+  s_game.background_index = background_index;
+  
+  // Initialize Pyoro
+  s_game.pyoro.x = (GAME_WIDTH << FX_SHIFT) / 2;
+  s_game.pyoro.y = (GAME_HEIGHT - 2) << FX_SHIFT;
+  s_game.pyoro.direction = 1;
+  
+  // Initialize blocks (beans and the angel start inactive)
+  s_game.blocks = BLOCK_MASK_ALL;
+  rebuild_support_map();
+  rebuild_bean_columns();
+}
+
+static void reset_game(void) {
+  init_game();
+  s_game.state = GAME_STATE_PLAYING;
+  // Fresh seed per run; stored with the score so the run can be replayed
+  s_game.seed = (uint32_t)time(NULL) ^ ((uint32_t)time_ms(NULL, NULL) << 16);
+  game_srand(s_game.seed);
+  s_prev_game = s_game;
+  s_sim_accum_ms = 0;
+  s_interp_alpha = 0;
+  // A run started under Quick View plays in the unobstructed area; only one
+  // already in progress when the screen gets covered is suspended
+  s_suspend_reasons &= ~SUSPEND_OBSTRUCTED;
+  memset(&s_watchdog, 0, sizeof(s_watchdog));
+  replay_reset();
+#ifdef TRACE
+  trace_reset();
+#endif
+  // Reset background to first image for new game
+  set_background(0);
+  window_set_click_config_provider(s_window, prv_click_config_provider);
+#ifdef DEBUG_HEAP_GUARD
+  s_heap_baseline = heap_bytes_used();
+  s_heap_guard_reported = false;
+#endif
+  layer_mark_dirty(s_game_layer);
+}
+
+// Find a destroyed block that can be repaired
+static int find_destroyed_block(void) {
+  uint32_t holes = ~(s_game.blocks | s_game.blocks_repairing) & BLOCK_MASK_ALL;
+  return holes ? __builtin_ctz(holes) : -1;
+}
+
+static inline int bean_limit(void) {
+  return s_game.swarm || s_game.waves ? MAX_BEANS : NORMAL_BEAN_LIMIT;
+}
+
+static inline int angel_limit(void) {
+  return s_game.swarm ? MAX_ANGELS : NORMAL_ANGEL_LIMIT;
+}
+
+// Roll each special type in table order; green if none comes up. Types that
+// need a missing block don't roll (or draw a random number) without one.
+static BeanType pick_bean_type(void) {
+  bool hole = find_destroyed_block() >= 0;
+  for (int type = BEAN_TYPE_GREEN + 1; type < NUM_BEAN_TYPES; type++) {
+    const BeanTypeInfo *info = &BEAN_TYPES[type];
+    if (info->spawn_needs_hole && !hole) {
+      continue;
+    }
+    if ((int)(game_rand() % BEAN_SPAWN_CHANCE_DENOM) < info->spawn_chance) {
+      return type;
+    }
+  }
+  return BEAN_TYPE_GREEN;
+}
+
+// First inactive bean slot within the mode's limit, or -1
+static int free_bean_slot(void) {
+  for (int i = 0; i < bean_limit(); i++) {
+    if (!s_game.beans[i].active) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void place_bean(int i, int column, int speed, BeanType type) {
+  s_game.beans[i].x = (column << FX_SHIFT) + FX_ONE / 2;
+  s_game.beans[i].y = 0;
+  s_game.beans[i].speed = speed;
+  s_game.beans[i].active = true;
+  s_game.beans[i].caught = false;
+  s_game.beans[i].type = type;
+  TRACE_INSTANT(TRACE_BEAN_SPAWNED, i);
+}
+
+// Spawn a new bean
+static void spawn_bean(void) {
+  int i = free_bean_slot();
+  if (i < 0) {
+    return;
+  }
+  int column = game_rand() % GAME_WIDTH;
+  int speed = game_rand() % 100 + 50;
+  place_bean(i, column, speed, pick_bean_type());
+}
+
+// Switch the fresh run to wave mode: open the script and start at its first
+// instruction. Without a usable script the random spawner stays in charge.
+static void start_wave_mode(void) {
+  s_game.waves = true;
+  memset(&s_game.wave, 0, sizeof(s_game.wave));
+  s_wave_stream.handle = resource_get_handle(RESOURCE_ID_WAVES_CAMPAIGN);
+  s_wave_stream.code_size = 0;
+  s_wave_stream.length = 0;
+  uint8_t header[WAVE_HEADER_SIZE];
+  if (resource_load_byte_range(s_wave_stream.handle, 0, header, sizeof(header)) == sizeof(header) &&
+      header[0] == 'W' && header[1] == 'V' && header[2] == WAVE_VERSION) {
+    uint16_t code_size = header[4] | (header[5] << 8);
+    if (resource_size(s_wave_stream.handle) >= WAVE_HEADER_SIZE + (size_t)code_size) {
+      s_wave_stream.code_size = code_size;
+    }
+  }
+  if (!s_wave_stream.code_size) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "No usable wave script; spawning at random");
+  }
+  s_game.wave.running = s_wave_stream.code_size != 0;
+}
+
+// The size bytes of code at pc, refilling the window from the resource when
+// they aren't in it; NULL past the end of the script
+static const uint8_t *wave_fetch(uint16_t pc, int size) {
+  if (pc + size > s_wave_stream.code_size) {
+    return NULL;
+  }
+  if (pc < s_wave_stream.start || pc + size > s_wave_stream.start + s_wave_stream.length) {
+    int length = s_wave_stream.code_size - pc < WAVE_WINDOW_SIZE ? s_wave_stream.code_size - pc : WAVE_WINDOW_SIZE;
+    s_wave_stream.start = pc;
+    s_wave_stream.length = resource_load_byte_range(s_wave_stream.handle, WAVE_HEADER_SIZE + pc,
+                                                    s_wave_stream.bytes, length);
+    if (s_wave_stream.length < size) {
+      return NULL;
+    }
+  }
+  return &s_wave_stream.bytes[pc - s_wave_stream.start];
+}
+
+// Same draws, in the same order, as spawn_bean for whatever the script leaves random
+static void wave_spawn_bean(uint8_t column, uint8_t type, uint8_t speed) {
+  int i = free_bean_slot();
+  if (i < 0) {
+    return;
+  }
+  int x = column == WAVE_RANDOM ? (int)(game_rand() % GAME_WIDTH) : column;
+  int fall = speed ? speed : (int)(game_rand() % 100 + 50);
+  place_bean(i, x, fall, type == WAVE_RANDOM ? pick_bean_type() : (BeanType)type);
+}
+
+// Run the wave script up to its next wait. Stops it (the random spawner takes
+// over) at endless, at the end of the code or at a malformed instruction.
+static void wave_step(void) {
+  WaveState *wave = &s_game.wave;
+  if (wave->wait && --wave->wait) {
+    return;
+  }
+  for (int n = 0; n < WAVE_MAX_OPS_PER_TICK; n++) {
+    const uint8_t *op = wave_fetch(wave->pc, 1);
+    if (op && *op < NUM_WAVE_OPS) {
+      op = wave_fetch(wave->pc, s_wave_op_sizes[*op]);
+    }
+    if (!op || *op >= NUM_WAVE_OPS) {
+      wave->running = false;
+      return;
+    }
+    uint16_t next = wave->pc + s_wave_op_sizes[op[0]];
+    switch (op[0]) {
+      case WAVE_OP_BEAN:
+        if ((op[1] >= GAME_WIDTH && op[1] != WAVE_RANDOM) || (op[2] >= NUM_BEAN_TYPES && op[2] != WAVE_RANDOM)) {
+          wave->running = false;
+          return;
+        }
+        wave_spawn_bean(op[1], op[2], op[3]);
+        break;
+      case WAVE_OP_WAIT:
+        wave->pc = next;
+        wave->wait = op[1] | (op[2] << 8);
+        return;
+      case WAVE_OP_REPEAT:
+        if (wave->depth == WAVE_MAX_DEPTH || op[1] == 0) {
+          wave->running = false;
+          return;
+        }
+        wave->loop_start[wave->depth] = next;
+        wave->loop_left[wave->depth] = op[1];
+        wave->depth++;
+        break;
+      case WAVE_OP_END:
+        if (wave->depth == 0) {
+          wave->running = false;
+          return;
+        }
+        if (--wave->loop_left[wave->depth - 1]) {
+          next = wave->loop_start[wave->depth - 1];
+        } else {
+          wave->depth--;
+        }
+        break;
+      case WAVE_OP_GOTO:
+        next = op[1] | (op[2] << 8);
+        break;
+      default: // WAVE_OP_ENDLESS
+        wave->running = false;
+        return;
+    }
+    wave->pc = next;
+  }
+}
+
+// Spawn an angel to repair a block
+static void spawn_angel(int block_index) {
+  if (block_index < 0 || block_index >= GAME_WIDTH) {
+    return;
+  }
+  if (((s_game.blocks | s_game.blocks_repairing) >> block_index) & 1) {
+    return;
+  }
+  Angel *angel = NULL;
+  for (int i = 0; i < angel_limit(); i++) {
+    if (!s_game.angels[i].active) {
+      angel = &s_game.angels[i];
+      break;
+    }
+  }
+  if (!angel) {
+    return; // All angels busy
+  }
+  
+  angel->active = true;
+  angel->x = (block_index << FX_SHIFT) + FX_ONE / 2;
+  angel->y = 0;
+  angel->target_block_index = block_index;
+  angel->going_up = false;
+  s_game.blocks_repairing |= 1u << block_index;
+}
+
+static inline int tongue_tip_x_fx(const Pyoro *pyoro) {
+  return pyoro->tongue.start_x + pyoro->tongue.direction * pyoro->tongue.ext;
+}
+
+static inline int tongue_tip_y_fx(const Pyoro *pyoro) {
+  return pyoro->tongue.start_y - pyoro->tongue.ext;
+}
+
+// Extension at which the tongue is back inside Pyoro (tip level with its centre)
+static inline int tongue_home_ext(const Pyoro *pyoro) {
+  return pyoro->tongue.start_y - pyoro->y;
+}
+
+// Shoot the tongue from Pyoro's mouth. The lattice origin and the extension
+// limit (first of the top or side wall along the diagonal) are fixed for the
+// whole shot since Pyoro can't move while the tongue is out.
+static void fire_tongue(void) {
+  Pyoro *pyoro = &s_game.pyoro;
+  pyoro->tongue.active = true;
+  pyoro->tongue.direction = pyoro->direction;
+  pyoro->tongue.start_x = pyoro->x + pyoro->direction * TONGUE_START_DX_FX;
+  pyoro->tongue.start_y = pyoro->y - TONGUE_START_DY_FX;
+  pyoro->tongue.ext = 0;
+  int side_room = pyoro->direction == 1 ? (GAME_WIDTH << FX_SHIFT) - pyoro->tongue.start_x
+                                        : pyoro->tongue.start_x;
+  pyoro->tongue.max_ext = side_room < pyoro->tongue.start_y ? side_room : pyoro->tongue.start_y;
+  pyoro->tongue.going_back = false;
+  pyoro->tongue.caught_bean = false;
+}
+
+// Integer AABB overlap test on centre/size boxes in fixed-point units
+static bool check_collision_fx(int x1, int y1, int w1, int h1,
+                               int x2, int y2, int w2, int h2) {
+  return (2 * x1 - w1 < 2 * x2 + w2) &&
+         (2 * x1 + w1 > 2 * x2 - w2) &&
+         (2 * y1 - h1 < 2 * y2 + h2) &&
+         (2 * y1 + h1 > 2 * y2 - h2);
+}
+
+static void apply_catch_effect(BeanEffect effect) {
+  switch (effect) {
+    case BEAN_EFFECT_REPAIR: {
+      int destroyed_block = find_destroyed_block();
+      if (destroyed_block >= 0) {
+        spawn_angel(destroyed_block);
+      }
+      break;
+    }
+    case BEAN_EFFECT_NONE:
+      break;
+  }
+}
+
+// Benchmark input: face the lowest falling bean and shoot when it sits on the
+// tongue's 45 degree path, otherwise walk to line the shot up
+static void benchmark_autoplay(void) {
+  Pyoro *pyoro = &s_game.pyoro;
+  if (pyoro->tongue.active) {
+    return;
+  }
+  const Bean *target = NULL;
+  for (int i = 0; i < MAX_BEANS; i++) {
+    const Bean *bean = &s_game.beans[i];
+    if (bean->active && !bean->caught && (!target || bean->y > target->y)) {
+      target = bean;
+    }
+  }
+  if (!target) {
+    return;
+  }
+  int dx = target->x - pyoro->x;
+  int gap = (dx < 0 ? -dx : dx) - (pyoro->y - target->y);
+  pyoro->direction = dx < 0 ? -1 : 1;
+  if (gap > -FX_ONE && gap < FX_ONE) {
+    s_game.pending_step_count = 0;
+    fire_tongue();
+  } else {
+    // Too far: close in; too close: back away while still facing the bean
+    s_game.pending_step_dir = gap > 0 ? pyoro->direction : -pyoro->direction;
+    s_game.pending_step_count = PYORO_STEPS_PER_TICK;
+  }
+}
+
+// Update game logic
+static void update_game(float delta_time) {
+  if (s_game.state != GAME_STATE_PLAYING || s_game.game_paused) {
+    return;
+  }
+  
+  // Handle death timer
+  if (s_game.pyoro.dead) {
+    if (s_game.death_ticks > 0) {
+      s_game.death_ticks--;
+    }
+    if (s_game.death_ticks == 0) {
+      s_last_game_score = s_game.score;
+      HighScoreEntry entry = {
+        .score = s_game.score,
+        .timestamp = (uint32_t)time(NULL),
+        .seed = s_game.seed,
+        .duration = (uint16_t)(s_game.ticks * SIM_TICK_MS / 1000),
+      };
+      // Swarm and wave scores aren't comparable with normal runs, so they stay off the records
+      s_last_game_rank = s_game.swarm || s_game.waves ? -1 : insert_high_score(&entry);
+      replay_finish();
+      s_overlay_dirty = true;
+      stats_record_game(s_game.score, s_game.ticks * SIM_DT);
+      // After the scores and stats, which storage must never refuse for it
+      if (s_last_game_rank == 0) {
+        replay_save_best();
+      }
+      s_game.state = GAME_STATE_GAME_OVER;
+      stop_game_timer();
+      window_set_click_config_provider(s_window, prv_click_config_provider); // Long press retries
+      if (s_flight.reason == FLIGHT_REASON_HITCH) {
+        flight_persist();
+      }
+      replay_dump();
+#ifdef TRACE
+      trace_dump();
+#endif
+    }
+    // Don't update game logic while dead (rendering continues)
+    return;
+  }
+  
+  replay_checkpoint();
+  float dt = delta_time * s_game.speed;
+  s_game.speed += dt * SPEED_ACCELERATION;
+  if (s_game.benchmark) {
+    benchmark_autoplay();
+  }
+  
+  // Update Pyoro movement:
+  TRACE_BEGIN(TRACE_INPUT);
+  if (s_game.pyoro.tongue.active) {
+    s_game.pending_step_count = 0;
+    s_game.pending_step_dir = 0;
+  } else if (s_game.pending_step_count > 0 && s_game.pending_step_dir != 0) {
+    for (int n = 0; n < PYORO_STEPS_PER_TICK && s_game.pending_step_count > 0; n++) {
+      apply_pyoro_step(s_game.pending_step_dir);
+      s_game.pending_step_count--;
+    }
+    if (s_game.pending_step_count <= 0) {
+      s_game.pending_step_dir = 0;
+    }
+  }
+  
+  TRACE_END(TRACE_INPUT);
+  
+  // Increment frame counter
+  s_game.ticks++;
+  
+  // (Legacy moving/button_held no longer used for horizontal movement)
+  
+  // Update tongue
+  TRACE_BEGIN(TRACE_TONGUE);
+  if (s_game.pyoro.tongue.active) {
+    if (s_game.pyoro.tongue.going_back) {
+      // Tongue retracting
+      s_game.pyoro.tongue.ext -= TO_FX(TONGUE_SPEED * 2.0f * dt);
+      int tip_x = tongue_tip_x_fx(&s_game.pyoro);
+      int tip_y = tongue_tip_y_fx(&s_game.pyoro);
+      
+      if (s_game.pyoro.tongue.caught_bean) {
+        // Move caught bean with tongue
+        for (int i = 0; i < MAX_BEANS; i++) {
+          if (s_game.beans[i].active && s_game.beans[i].caught) {
+            s_game.beans[i].x = tip_x;
+            s_game.beans[i].y = tip_y;
+            break;
+          }
+        }
+      }
+      
+      // Check if tongue is back
+      if (s_game.pyoro.tongue.ext <= tongue_home_ext(&s_game.pyoro)) {
+        if (s_game.pyoro.tongue.caught_bean) {
+          // Find the caught bean and apply its type's effect and score rule
+          for (int i = 0; i < MAX_BEANS; i++) {
+            if (s_game.beans[i].active && s_game.beans[i].caught) {
+              const BeanTypeInfo *info = &BEAN_TYPES[s_game.beans[i].type];
+              apply_catch_effect(info->catch_effect);
+              
+              // Score by the tip's height once home, as the game always has;
+              // the stats bin the height the bean was actually caught at
+              int score_add = s_catch_band_points[catch_band(tip_y)] * info->score_multiplier;
+              s_game.score += score_add;
+              stats_record_catch(s_game.pyoro.tongue.catch_band);
+              TRACE_INSTANT(TRACE_BEAN_CAUGHT, score_add);
+              
+              // Remove caught bean
+              s_game.beans[i].active = false;
+              break;
+            }
+          }
+        }
+        s_game.pyoro.tongue.active = false;
+      }
+    } else {
+      // Tongue extending
+      s_game.pyoro.tongue.ext += TO_FX(TONGUE_SPEED * dt);
+      int tip_x = tongue_tip_x_fx(&s_game.pyoro);
+      int tip_y = tongue_tip_y_fx(&s_game.pyoro);
+      
+      // Check for bean collision (lowest slot first, as before)
+      for (uint64_t near = beans_near(tip_x, TONGUE_WIDTH << FX_SHIFT); near; near &= near - 1) {
+        int i = __builtin_ctzll(near);
+        if (check_collision_fx(tip_x, tip_y,
+                               TONGUE_WIDTH << FX_SHIFT, TONGUE_WIDTH << FX_SHIFT,
+                               s_game.beans[i].x, s_game.beans[i].y,
+                               BEAN_SIZE << FX_SHIFT, BEAN_SIZE << FX_SHIFT)) {
+          s_game.beans[i].caught = true;
+          s_game.pyoro.tongue.caught_bean = true;
+          s_game.pyoro.tongue.catch_band = catch_band(tip_y);
+          s_game.pyoro.tongue.going_back = true;
+          break;
+        }
       }
       
       // Check if tongue is out of bounds
-      if (s_game.pyoro.tongue.x < 0 || s_game.pyoro.tongue.x > GAME_WIDTH ||
-          s_game.pyoro.tongue.y < 0) {
+      if (s_game.pyoro.tongue.ext > s_game.pyoro.tongue.max_ext) {
         s_game.pyoro.tongue.going_back = true;
       }
     }
   }
-  
-  // Update beans
-  for (int i = 0; i < 5; i++) {
-    if (s_game.beans[i].active && !s_game.beans[i].caught) {
-      s_game.beans[i].y += BEAN_SPEED * s_game.beans[i].speed * dt;
-      
-      // Check collision with Pyoro
-      if (!s_game.pyoro.dead && !s_game.pyoro.tongue.active) {
-        if (check_collision(s_game.pyoro.x, s_game.pyoro.y,
-                           PYORO_SIZE, PYORO_SIZE,
-                           s_game.beans[i].x, s_game.beans[i].y,
-                           BEAN_SIZE, BEAN_SIZE)) {
-          // Pyoro dies - start death timer
-          s_game.pyoro.dead = true;
-          s_game.death_timer = DEATH_DELAY;
-          break;
-        }
+  
+  TRACE_END(TRACE_TONGUE);
+  
+  // Update beans: every falling bean drops at its own speed, then landings
+  // are checked in slot order
+  TRACE_BEGIN(TRACE_BEANS);
+  uint64_t falling = 0;
+  for (int i = 0; i < MAX_BEANS; i++) {
+    Bean *bean = &s_game.beans[i];
+    if (bean->active && !bean->caught) {
+      bean->y += TO_FX_ROUND(BEAN_SPEED * bean->speed / 100.0f * dt);
+      falling |= 1ull << i;
+    }
+  }
+  for (; falling; falling &= falling - 1) {
+    int i = __builtin_ctzll(falling);
+    // Check collision with ground/blocks
+    if (s_game.beans[i].y >= (GAME_HEIGHT - 1) << FX_SHIFT) {
+      int block_index = s_game.beans[i].x >> FX_SHIFT;
+      if (block_index >= 0 && block_index < GAME_WIDTH) {
+        if (block_exists(block_index)) {
+          s_game.blocks &= ~(1u << block_index);
+          rebuild_support_map();
+          invalidate_block_row();
+          stats_record_block_lost();
+        }
+      }
+      s_game.beans[i].active = false;
+    }
+  }
+  
+  TRACE_END(TRACE_BEANS);
+  
+  // Update angels
+  TRACE_BEGIN(TRACE_ANGELS);
+  for (int i = 0; i < MAX_ANGELS; i++) {
+    Angel *angel = &s_game.angels[i];
+    if (!angel->active) {
+      continue;
+    }
+    if (!angel->going_up) {
+      // Angel falling down
+      angel->y += TO_FX_ROUND(ANGEL_SPEED * dt);
+      
+      // Check if angel reached the block
+      if (angel->y >= (GAME_HEIGHT - 1) << FX_SHIFT) {
+        // Repair the block
+        int block_idx = angel->target_block_index;
+        if (block_idx >= 0 && block_idx < GAME_WIDTH) {
+          s_game.blocks |= 1u << block_idx;
+          s_game.blocks_repairing &= ~(1u << block_idx);
+          rebuild_support_map();
+          invalidate_block_row();
+        }
+        // Start going back up
+        angel->going_up = true;
+      }
+    } else {
+      // Angel going back up
+      angel->y -= TO_FX_ROUND(ANGEL_SPEED * dt);
+      
+      // Check if angel exited the screen
+      if (angel->y < 0) {
+        angel->active = false;
+      }
+    }
+  }
+  
+  TRACE_END(TRACE_ANGELS);
+  
+  // Spawn new beans
+  TRACE_BEGIN(TRACE_SPAWN);
+  if (s_game.wave.running) {
+    wave_step();
+  } else {
+    s_game.bean_spawn_timer += dt;
+    float spawn_interval = BEAN_SPAWN_FREQUENCY / s_game.speed;
+    if (s_game.swarm) {
+      spawn_interval /= SWARM_SPAWN_RATE;
+    }
+    if (s_game.benchmark || s_game.bean_spawn_timer >= spawn_interval) {
+      spawn_bean();
+      s_game.bean_spawn_timer = 0.0f;
+    }
+  }
+  rebuild_bean_columns();
+  
+  // Check collision with Pyoro
+  if (!s_game.pyoro.tongue.active && !s_game.benchmark) {
+    for (uint64_t near = beans_near(s_game.pyoro.x, PYORO_SIZE << FX_SHIFT); near; near &= near - 1) {
+      int i = __builtin_ctzll(near);
+      if (check_collision_fx(s_game.pyoro.x, s_game.pyoro.y,
+                             PYORO_SIZE << FX_SHIFT, PYORO_SIZE << FX_SHIFT,
+                             s_game.beans[i].x, s_game.beans[i].y,
+                             BEAN_SIZE << FX_SHIFT, BEAN_SIZE << FX_SHIFT)) {
+        // Pyoro dies - start death timer
+        s_game.pyoro.dead = true;
+        s_game.death_ticks = DEATH_DELAY_TICKS;
+        TRACE_INSTANT(TRACE_PYORO_DIED, s_game.score);
+        break;
+      }
+    }
+  }
+  TRACE_END(TRACE_SPAWN);
+  
+  // Update score display
+  static char score_text[20];
+  snprintf(score_text, sizeof(score_text), "Score: %ld", (long)s_game.score);
+  text_layer_set_text(s_score_layer, score_text);
+  
+  // Advance background slowly as score increases (only when playing)
+  TRACE_BEGIN(TRACE_STAGE);
+  if (s_game.state == GAME_STATE_PLAYING && s_game.benchmark) {
+    if (s_game.ticks % BENCHMARK_TICKS_PER_BACKGROUND == 0) {
+      set_background((s_game.background_index + 1) % NUM_BACKGROUNDS);
+    }
+  } else if (s_game.state == GAME_STATE_PLAYING) {
+    int new_bg = s_game.score / SCORE_PER_BACKGROUND;
+    if (new_bg >= NUM_BACKGROUNDS) {
+      new_bg = NUM_BACKGROUNDS - 1;
+    }
+    if (new_bg != s_game.background_index) {
+      set_background(new_bg);
+    }
+#if PROCEDURAL_SKY
+    // Fade toward the next stage between steps; only catches change the score
+    int sky_position = new_bg << 8;
+    if (new_bg < NUM_BACKGROUNDS - 1) {
+      sky_position += (s_game.score % SCORE_PER_BACKGROUND) * 256 / SCORE_PER_BACKGROUND;
+    }
+    if (sky_position != s_sky_position) {
+      s_sky_position = sky_position;
+      invalidate_scene();
+    }
+#endif
+  }
+  TRACE_END(TRACE_STAGE);
+}
+
+// Draw a histogram as bars scaled to its tallest bucket
+static void draw_histogram(GContext *ctx, const uint16_t *buckets, int num_buckets, GRect frame) {
+  uint16_t max_count = 1;
+  for (int i = 0; i < num_buckets; i++) {
+    if (buckets[i] > max_count) {
+      max_count = buckets[i];
+    }
+  }
+  int bar_w = frame.size.w / num_buckets;
+  graphics_context_set_fill_color(ctx, GColorYellow);
+  for (int i = 0; i < num_buckets; i++) {
+    int bar_h = buckets[i] * frame.size.h / max_count;
+    if (buckets[i] > 0 && bar_h < 1) {
+      bar_h = 1;
+    }
+    graphics_fill_rect(ctx, GRect(frame.origin.x + i * bar_w, frame.origin.y + frame.size.h - bar_h,
+                                  bar_w > 1 ? bar_w - 1 : 1, bar_h), 0, GCornerNone);
+  }
+}
+
+// Lifetime stats screen: rendered entirely from the fixed-size counters
+static void draw_stats_screen(GContext *ctx, GRect bounds) {
+  int screen_width = bounds.size.w;
+  int screen_height = bounds.size.h;
+  graphics_context_set_fill_color(ctx, GColorBlack);
+  graphics_fill_rect(ctx, GRect(2, 2, screen_width - 4, screen_height - 4), 4, GCornerNone);
+  graphics_context_set_text_color(ctx, GColorWhite);
+  graphics_draw_text(ctx, "STATS", fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                    GRect(0, 2, screen_width, 20),
+                    GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+
+  static char summary_buf[64];
+  static char time_buf[64];
+  static char catch_buf[80];
+  uint32_t games = s_stats.games_played;
+  uint32_t avg_score = games ? s_stats.total_score / games : 0;
+  snprintf(summary_buf, sizeof(summary_buf), "Games %lu  Best %ld  Avg %lu",
+           (unsigned long)games, (long)(s_stats.best_score < 0 ? 0 : s_stats.best_score),
+           (unsigned long)avg_score);
+  // Blocks lost per minute, in tenths (no %f in the Pebble libc)
+  uint32_t lost_per_min_x10 = s_stats.total_play_seconds ?
+      s_stats.total_blocks_lost * 600 / s_stats.total_play_seconds : 0;
+  snprintf(time_buf, sizeof(time_buf), "Played %lum  Lost/min %lu.%lu",
+           (unsigned long)(s_stats.total_play_seconds / 60),
+           (unsigned long)(lost_per_min_x10 / 10), (unsigned long)(lost_per_min_x10 % 10));
+  snprintf(catch_buf, sizeof(catch_buf), "Catches 10:%lu 50:%lu 100:%lu 300:%lu 1k:%lu",
+           (unsigned long)s_stats.catches[0], (unsigned long)s_stats.catches[1],
+           (unsigned long)s_stats.catches[2], (unsigned long)s_stats.catches[3],
+           (unsigned long)s_stats.catches[4]);
+
+  GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+  graphics_draw_text(ctx, summary_buf, font, GRect(4, 22, screen_width - 8, 16),
+                    GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+  graphics_draw_text(ctx, time_buf, font, GRect(4, 36, screen_width - 8, 16),
+                    GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+  graphics_draw_text(ctx, catch_buf, font, GRect(4, 50, screen_width - 8, 30),
+                    GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+
+  int graph_w = screen_width - 16;
+  graphics_draw_text(ctx, "Scores (log)", font, GRect(4, 80, screen_width - 8, 16),
+                    GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+  draw_histogram(ctx, s_stats.score_histogram, STATS_SCORE_BUCKETS, GRect(8, 96, graph_w, 14));
+  graphics_draw_text(ctx, "Survival (log s)", font, GRect(4, 112, screen_width - 8, 16),
+                    GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+  draw_histogram(ctx, s_stats.survival_histogram, STATS_SURVIVAL_BUCKETS, GRect(8, 128, graph_w, 14));
+  graphics_context_set_text_color(ctx, GColorWhite);
+  graphics_draw_text(ctx, "SELECT: menu  DOWN: log", font,
+                    GRect(0, screen_height - 20, screen_width, 16),
+                    GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
+
+// Flight recorder: what was persisted and why, and each frame's cost as a
+// bar (update plus draw, clipped at the hitch threshold) with the frame budget
+static void draw_flight_screen(GContext *ctx, GRect bounds) {
+  int screen_width = bounds.size.w;
+  int screen_height = bounds.size.h;
+  graphics_context_set_fill_color(ctx, GColorBlack);
+  graphics_fill_rect(ctx, GRect(2, 2, screen_width - 4, screen_height - 4), 4, GCornerNone);
+  graphics_context_set_text_color(ctx, GColorWhite);
+  graphics_draw_text(ctx, "FLIGHT LOG", fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                    GRect(0, 2, screen_width, 20),
+                    GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+
+  static char info_buf[96];
+  const FlightHeader *header = &s_flight.loaded;
+  uint32_t worst = 0;
+  uint32_t heap_min = UINT32_MAX;
+  for (int i = 0; i < header->count; i++) {
+    uint32_t cost = s_flight.records[i].update_ms + s_flight.records[i].draw_ms;
+    if (cost > worst) {
+      worst = cost;
+    }
+    if (s_flight.records[i].heap_free_4 * 4u < heap_min) {
+      heap_min = s_flight.records[i].heap_free_4 * 4u;
+    }
+  }
+  if (header->count == 0) {
+    snprintf(info_buf, sizeof(info_buf), "No recording");
+  } else if (header->reason == FLIGHT_REASON_HITCH) {
+    snprintf(info_buf, sizeof(info_buf), "Hitch %ums, %u frames from end\nWorst %lums  Heap min %lu B",
+             header->hitch_ms, header->hitch_age, (unsigned long)worst, (unsigned long)heap_min);
+  } else {
+    snprintf(info_buf, sizeof(info_buf), "Work shed\nWorst %lums  Heap min %lu B",
+             (unsigned long)worst, (unsigned long)heap_min);
+  }
+  GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+  graphics_draw_text(ctx, info_buf, font, GRect(4, 22, screen_width - 8, 32),
+                    GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+  if (s_flight.previous_crashed) {
+    graphics_draw_text(ctx, "Last session crashed", font, GRect(4, 52, screen_width - 8, 16),
+                      GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+  }
+
+  // Each column shows the worst frame it covers
+  GRect graph = GRect(8, 72, screen_width - 16, screen_height - 100);
+  graphics_context_set_stroke_color(ctx, GColorWhite);
+  graphics_draw_rect(ctx, graph);
+  graphics_context_set_fill_color(ctx, GColorWhite);
+  for (int x = 0; x < graph.size.w - 2 && header->count > 0; x++) {
+    int first = x * header->count / (graph.size.w - 2);
+    int last = (x + 1) * header->count / (graph.size.w - 2);
+    uint32_t cost = 0;
+    for (int i = first; i <= last && i < header->count; i++) {
+      uint32_t frame = s_flight.records[i].update_ms + s_flight.records[i].draw_ms;
+      cost = frame > cost ? frame : cost;
+    }
+    int h = (cost > FLIGHT_HITCH_MS ? FLIGHT_HITCH_MS : cost) * (graph.size.h - 2) / FLIGHT_HITCH_MS;
+    if (h > 0) {
+      graphics_fill_rect(ctx, GRect(graph.origin.x + 1 + x, graph.origin.y + graph.size.h - 1 - h, 1, h),
+                         0, GCornerNone);
+    }
+  }
+  int budget_y = graph.origin.y + graph.size.h - 1 - WATCHDOG_BUDGET_MS * (graph.size.h - 2) / FLIGHT_HITCH_MS;
+  for (int x = graph.origin.x + 1; x < graph.origin.x + graph.size.w - 1; x += 4) {
+    graphics_draw_pixel(ctx, GPoint(x, budget_y));
+  }
+  graphics_draw_text(ctx, "SELECT: menu", font,
+                    GRect(0, screen_height - 20, screen_width, 16),
+                    GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
+
+static void update_layout(GRect bounds) {
+  s_layout.bounds = bounds;
+  s_layout.screen_width = bounds.size.w;
+  s_layout.screen_height = bounds.size.h;
+  s_layout.game_pixel_width = bounds.size.w;
+  s_layout.game_pixel_height = bounds.size.h - 20; // Reserve space for score
+  s_layout.scale_x = (float)s_layout.game_pixel_width / GAME_WIDTH;
+  s_layout.scale_y = (float)s_layout.game_pixel_height / GAME_HEIGHT;
+  // Blocks sit at the bottom of the game area (below the score strip)
+  int block_y = 20 + (int)((GAME_HEIGHT - 1) * s_layout.scale_y);
+  for (int i = 0; i < GAME_WIDTH; i++) {
+    s_layout.block_rects[i] = GRect((int)(i * s_layout.scale_x), block_y,
+                                    (int)s_layout.scale_x, (int)s_layout.scale_y);
+  }
+  invalidate_scene();
+}
+
+// Blend a fixed-point coordinate from the previous tick towards the current
+// one, in game units. Large jumps (a bean slot reused for a new spawn) snap.
+static float interp_position(int prev, int cur) {
+  int delta = cur - prev;
+  if (delta > TO_FX(INTERP_SNAP_DISTANCE) || delta < -TO_FX(INTERP_SNAP_DISTANCE)) {
+    return FX_TO_FLOAT(cur);
+  }
+  return FX_TO_FLOAT(prev + delta * s_interp_alpha / 256);
+}
+
+#if BACKGROUND_STREAMED
+// Stream background rows [top, bottom) from the resource pack into the
+// framebuffer, BG_STRIP_ROWS rows per resource read
+static void stream_background_rows(GContext *ctx, int top, int bottom) {
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return;
+  }
+  GRect fb_bounds = gbitmap_get_bounds(fb);
+  if (bottom > fb_bounds.size.h) {
+    bottom = fb_bounds.size.h;
+  }
+  if (bottom > s_background_rows_height) {
+    bottom = s_background_rows_height;
+  }
+  if (top < 0) {
+    top = 0;
+  }
+  uint8_t *fb_data = gbitmap_get_data(fb);
+  int fb_stride = gbitmap_get_bytes_per_row(fb);
+  int row_bytes = (s_background_rows_width + 7) / 8;
+  int copy_bytes = row_bytes < fb_stride ? row_bytes : fb_stride;
+  for (int y = top; y < bottom; y += BG_STRIP_ROWS) {
+    int rows = bottom - y < BG_STRIP_ROWS ? bottom - y : BG_STRIP_ROWS;
+    resource_load_byte_range(s_background_rows, BG_ROWS_HEADER_SIZE + y * row_bytes,
+                             s_background_strip, rows * row_bytes);
+    for (int r = 0; r < rows; r++) {
+      memcpy(fb_data + (y + r) * fb_stride, s_background_strip + r * row_bytes, copy_bytes);
+    }
+  }
+  graphics_release_frame_buffer(ctx, fb);
+}
+
+#ifdef BENCHMARK_BACKGROUND_STREAMING
+// Log what streaming a full screen of background rows costs on this watch:
+// every background is read strip by strip, as a full scene rebuild would
+static void benchmark_background_streaming(void) {
+  const int passes = 4;
+  uint32_t bytes = 0;
+  uint32_t start = wall_ms();
+  for (int pass = 0; pass < passes; pass++) {
+    for (int i = 0; i < NUM_BACKGROUNDS; i++) {
+      set_background(i);
+      int row_bytes = (s_background_rows_width + 7) / 8;
+      for (int y = 0; y < s_background_rows_height; y += BG_STRIP_ROWS) {
+        int rows = s_background_rows_height - y < BG_STRIP_ROWS ? s_background_rows_height - y : BG_STRIP_ROWS;
+        bytes += resource_load_byte_range(s_background_rows, BG_ROWS_HEADER_SIZE + y * row_bytes,
+                                          s_background_strip, rows * row_bytes);
+      }
+    }
+  }
+  uint32_t elapsed = wall_ms() - start;
+  int frames = passes * NUM_BACKGROUNDS;
+  APP_LOG(APP_LOG_LEVEL_INFO, "bg stream: %d full frames, %lu bytes each, %lu us/frame",
+          frames, (unsigned long)(bytes / frames), (unsigned long)(elapsed * 1000 / frames));
+  set_background(0);
+}
+#endif
+#endif
+
+#if PROCEDURAL_SKY
+static void sky_lerp(uint8_t out[3], const uint8_t a[3], const uint8_t b[3], int t, int range) {
+  for (int i = 0; i < 3; i++) {
+    out[i] = a[i] + (b[i] - a[i]) * t / range;
+  }
+}
+
+// Quantize to the 2-bit-per-channel palette with a 4-row ordered dither, so
+// gradients band per row and each row stays a single fill span
+static GColor sky_dither(const uint8_t rgb[3], int y) {
+  static const uint8_t threshold[4] = { 1, 5, 3, 7 };
+  int t = threshold[y & 3] * 255;
+  uint8_t argb = 0xC0;
+  for (int i = 0; i < 3; i++) {
+    int level = (rgb[i] * 24 + t) / (255 * 8);
+    argb |= (level > 3 ? 3 : level) << (4 - 2 * i);
+  }
+  return (GColor){ .argb = argb };
+}
+
+static void draw_procedural_sky(GContext *ctx, GRect bounds) {
+  // Blend this stage's keyframe with the next one
+  int stage = s_sky_position >> 8;
+  int frac = s_sky_position & 0xFF;
+  const SkyKeyframe *a = &s_sky_keyframes[stage];
+  const SkyKeyframe *b = &s_sky_keyframes[stage < NUM_BACKGROUNDS - 1 ? stage + 1 : stage];
+  SkyKeyframe k;
+  sky_lerp(k.sky_top, a->sky_top, b->sky_top, frac, 256);
+  sky_lerp(k.sky_mid, a->sky_mid, b->sky_mid, frac, 256);
+  sky_lerp(k.sky_bottom, a->sky_bottom, b->sky_bottom, frac, 256);
+  sky_lerp(k.clouds, a->clouds, b->clouds, frac, 256);
+  sky_lerp(k.hills, a->hills, b->hills, frac, 256);
+  sky_lerp(k.ground_top, a->ground_top, b->ground_top, frac, 256);
+  sky_lerp(k.ground_bottom, a->ground_bottom, b->ground_bottom, frac, 256);
+  sky_lerp(k.lights, a->lights, b->lights, frac, 256);
+  k.cloud_row = a->cloud_row + (b->cloud_row - a->cloud_row) * frac / 256;
+  k.cloud_cover = a->cloud_cover + (b->cloud_cover - a->cloud_cover) * frac / 256;
+  k.skyline = a->skyline + (b->skyline - a->skyline) * frac / 256;
+  k.stars = a->stars + (b->stars - a->stars) * frac / 256;
+
+  int w = bounds.size.w;
+  int h = bounds.size.h;
+  int mid = SKY_MID_ROW * h / SKY_DESIGN_HEIGHT;
+  int horizon = SKY_HORIZON_ROW * h / SKY_DESIGN_HEIGHT;
+
+  // Gradient rows, merged into one span while the dithered color repeats
+  int span_start = 0;
+  GColor span_color = GColorClear;
+  for (int y = 0; y <= h; y++) {
+    GColor color = GColorClear;
+    if (y < h) {
+      uint8_t rgb[3];
+      if (y < mid) {
+        sky_lerp(rgb, k.sky_top, k.sky_mid, y, mid);
+      } else if (y < horizon) {
+        sky_lerp(rgb, k.sky_mid, k.sky_bottom, y - mid, horizon - mid);
+      } else {
+        sky_lerp(rgb, k.ground_top, k.ground_bottom, y - horizon, h - horizon);
+      }
+      color = sky_dither(rgb, y);
+    }
+    if (y > 0 && (y == h || color.argb != span_color.argb)) {
+      graphics_context_set_fill_color(ctx, span_color);
+      graphics_fill_rect(ctx, GRect(bounds.origin.x, bounds.origin.y + span_start, w, y - span_start),
+                         0, GCornerNone);
+      span_start = y;
+    }
+    span_color = color;
+  }
+
+  // Cloud band: evenly spaced lumps of three stacked rects, each nudged by a
+  // fixed hash so the band doesn't look ruled
+  int lumps = k.cloud_cover * w / (SKY_HILL_COLUMNS * SKY_HILL_COLUMN_WIDTH);
+  if (lumps > 0) {
+    int cloud_y = k.cloud_row * h / SKY_DESIGN_HEIGHT;
+    int cloud_w = SKY_CLOUD_WIDTH * h / SKY_DESIGN_HEIGHT;
+    int row_h = 4 * h / SKY_DESIGN_HEIGHT;
+    graphics_context_set_fill_color(ctx, sky_dither(k.clouds, SKY_FLAT_ROW));
+    uint32_t hash = 0x7F4A7C15u;
+    for (int i = 0; i < lumps; i++) {
+      hash = hash * 1664525u + 1013904223u;
+      int x = bounds.origin.x + i * w / lumps + (int)(hash >> 24) % (w / lumps / 2 + 1);
+      int y = bounds.origin.y + cloud_y + (int)(hash >> 20) % 5 - 2;
+      graphics_fill_rect(ctx, GRect(x, y, cloud_w, row_h), 0, GCornerNone);
+      graphics_fill_rect(ctx, GRect(x + cloud_w / 4, y - row_h, cloud_w / 2, row_h), 0, GCornerNone);
+      graphics_fill_rect(ctx, GRect(x + cloud_w / 8, y + row_h, cloud_w * 3 / 4, row_h / 2 + 1), 0,
+                         GCornerNone);
+    }
+  }
+
+  // Hill band, tiled across the width like the art: one rect per run of
+  // equal profile heights
+  graphics_context_set_fill_color(ctx, sky_dither(k.hills, SKY_FLAT_ROW));
+  for (int x = 0, i = 0; x < w; ) {
+    int top = s_sky_hill_profile[i];
+    int run_w = 0;
+    do {
+      run_w += SKY_HILL_COLUMN_WIDTH;
+      i = (i + 1) % SKY_HILL_COLUMNS;
+    } while (i != 0 && s_sky_hill_profile[i] == top);
+    top = top * h / SKY_DESIGN_HEIGHT;
+    if (top < horizon) {
+      graphics_fill_rect(ctx, GRect(bounds.origin.x + x, bounds.origin.y + top, run_w, horizon - top),
+                         0, GCornerNone);
+    }
+    x += run_w;
+  }
+
+  // Skyline in front of the hills, its lit windows a grid of dots
+  int skyline = k.skyline * h / SKY_DESIGN_HEIGHT;
+  if (skyline > 0) {
+    int column_w = SKY_SKYLINE_COLUMN_WIDTH * w / (SKY_HILL_COLUMNS * SKY_HILL_COLUMN_WIDTH);
+    GColor windows = sky_dither(k.lights, SKY_FLAT_ROW);
+    for (int x = 0, i = 0; x < w; x += column_w, i = (i + 1) % SKY_SKYLINE_COLUMNS) {
+      int building_h = skyline * s_sky_skyline_profile[i] / 255;
+      if (building_h < 4) {
+        continue;
+      }
+      int left = bounds.origin.x + x + 2;
+      int top = bounds.origin.y + horizon - building_h;
+      graphics_context_set_fill_color(ctx, sky_dither(k.hills, SKY_FLAT_ROW));
+      graphics_fill_rect(ctx, GRect(left, top, column_w - 4, building_h), 0, GCornerNone);
+      graphics_context_set_fill_color(ctx, windows);
+      for (int wy = top + 2; wy < top + building_h - 2; wy += 5) {
+        for (int wx = left + 2; wx < left + column_w - 6; wx += 4) {
+          graphics_fill_rect(ctx, GRect(wx, wy, 1, 2), 0, GCornerNone);
+        }
+      }
+    }
+  }
+
+  // Stars at fixed pseudo-random spots in the upper sky
+  graphics_context_set_fill_color(ctx, sky_dither(k.lights, SKY_FLAT_ROW));
+  uint32_t hash = 0x9E3779B9u;
+  for (int i = 0; i < k.stars; i++) {
+    hash = hash * 1664525u + 1013904223u;
+    int x = (hash >> 8) % w;
+    int y = (hash >> 20) % mid;
+    graphics_fill_rect(ctx, GRect(bounds.origin.x + x, bounds.origin.y + y, 2, 2), 0, GCornerNone);
+  }
+}
+#endif
+
+static void draw_background(GContext *ctx, GRect bounds) {
+#if PROCEDURAL_SKY
+  draw_procedural_sky(ctx, bounds);
+  return;
+#elif BACKGROUND_STREAMED
+  stream_background_rows(ctx, bounds.origin.y, bounds.origin.y + bounds.size.h);
+  return;
+#endif
+  if (s_background_bitmap) {
+    graphics_draw_bitmap_in_rect(ctx, s_background_bitmap, bounds);
+  } else {
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  }
+}
+
+static void draw_blocks(GContext *ctx) {
+  for (int i = 0; i < GAME_WIDTH; i++) {
+    if (block_exists(i)) {
+      GRect block_rect = s_layout.block_rects[i];
+      if (s_block_bitmap) {
+        graphics_draw_bitmap_in_rect(ctx, s_block_bitmap, block_rect);
+      } else {
+        // Fallback to gray rectangle if bitmap not loaded
+        graphics_context_set_fill_color(ctx, GColorDarkGray);
+        graphics_fill_rect(ctx, block_rect, 0, GCornerNone);
+      }
+    }
+  }
+}
+
+// Bytes of pixel data in the framebuffer (rows may be inset on round displays)
+static size_t framebuffer_data_size(GBitmap *fb) {
+  GRect fb_bounds = gbitmap_get_bounds(fb);
+  GBitmapDataRowInfo last_row = gbitmap_get_data_row_info(fb, fb_bounds.size.h - 1);
+  size_t last_row_offset = last_row.data - gbitmap_get_data(fb);
+#if defined(PBL_BW)
+  return last_row_offset + gbitmap_get_bytes_per_row(fb);
+#else
+  return last_row_offset + last_row.max_x + 1;
+#endif
+}
+
+#if defined(PBL_COLOR)
+// Capture the strip rows of a freshly drawn scene and paint clouds into them.
+// Cloud blobs are ellipses placed with wraparound, so the strip tiles
+// seamlessly at any scroll offset.
+static void build_cloud_strips(GBitmap *fb) {
+  GRect fb_bounds = gbitmap_get_bounds(fb);
+  s_clouds_ready = false;
+  for (int i = 0; i < CLOUD_STRIPS; i++) {
+    const CloudStrip *strip = &s_cloud_strips[i];
+    if (strip->top + strip->rows > fb_bounds.size.h) {
+      return;
+    }
+    int half_h = strip->rows / 2;
+    for (int r = 0; r < strip->rows; r++) {
+      GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, strip->top + r);
+      int width = info.max_x - info.min_x + 1;
+      if (width > CLOUD_ROW_MAX_WIDTH) {
+        return;
       }
-      
-      // Check collision with ground/blocks
-      if (s_game.beans[i].y >= GAME_HEIGHT - 1.0f) {
-        int block_index = (int)s_game.beans[i].x;
-        if (block_index >= 0 && block_index < GAME_WIDTH) {
-          if (s_game.blocks[block_index].exists) {
-            s_game.blocks[block_index].exists = false;
+      uint8_t *row = s_cloud_pixels[i][r];
+      memcpy(row, info.data + info.min_x, width);
+      int dy = r - half_h;
+      uint8_t shade = dy < 0 ? GColorWhiteARGB8 : GColorLightGrayARGB8;
+      // Three blobs per strip, spaced evenly around the row
+      for (int b = 0; b < 3; b++) {
+        int center = (width * b / 3 + i * 23) % width;
+        int half_w = 10 + ((b * 7 + i * 5) % 9);
+        int reach_sq = half_w * half_w * (half_h * half_h - dy * dy) / (half_h * half_h);
+        for (int dx = -half_w; dx <= half_w; dx++) {
+          if (dx * dx <= reach_sq) {
+            row[(center + dx + width) % width] = shade;
           }
         }
-        s_game.beans[i].active = false;
       }
     }
   }
-  
-  // Update angel
-  if (s_game.angel.active) {
-    if (!s_game.angel.going_up) {
-      // Angel falling down
-      s_game.angel.y += ANGEL_SPEED * dt;
-      
-      // Check if angel reached the block
-      if (s_game.angel.y >= GAME_HEIGHT - 1.0f) {
-        // Repair the block
-        int block_idx = s_game.angel.target_block_index;
-        if (block_idx >= 0 && block_idx < GAME_WIDTH) {
-          s_game.blocks[block_idx].exists = true;
-          s_game.blocks[block_idx].is_repairing = false;
-        }
-        // Start going back up
-        s_game.angel.going_up = true;
+  s_clouds_ready = true;
+}
+#endif
+
+// Reserve the scene cache at window load, before there is a framebuffer to
+// measure: a row is at most a byte per pixel, or 32-bit aligned words of bits
+static void reserve_scene_cache(GSize size) {
+#if defined(PBL_BW)
+  s_scene_cache_capacity = (size_t)(size.w + 31) / 32 * 4 * size.h;
+#else
+  s_scene_cache_capacity = (size_t)size.w * size.h;
+#endif
+  s_scene_cache = malloc(s_scene_cache_capacity);
+  s_scene_cache_size = 0;
+}
+
+// Measure the framebuffer the first time the scene is drawn; false while the
+// cache can't be used. A framebuffer the reservation can't hold gives up the
+// cache rather than allocate mid-run.
+static bool size_scene_cache(GContext *ctx) {
+  if (!s_scene_cache || s_scene_cache_size) {
+    return s_scene_cache != NULL;
+  }
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  s_scene_cache_size = framebuffer_data_size(fb);
+  graphics_release_frame_buffer(ctx, fb);
+  if (s_scene_cache_size > s_scene_cache_capacity) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Scene cache too small: %d of %d bytes",
+            (int)s_scene_cache_capacity, (int)s_scene_cache_size);
+    free(s_scene_cache);
+    s_scene_cache = NULL;
+  }
+  invalidate_scene();
+  return s_scene_cache != NULL;
+}
+
+// Background + blocks. Copies the cached composite into the framebuffer when
+// it is still valid; otherwise draws both and refreshes the cache. If the cache
+// can't be allocated this degrades to drawing the scene every frame. On a
+// frame the watchdog defers, damaged rows wait for the next one.
+static void draw_static_scene(GContext *ctx, GRect bounds) {
+  bool cached = size_scene_cache(ctx);
+  bool dirty = s_scene_dirty_top < s_scene_dirty_bottom && !(cached && s_watchdog.defer_scene);
+  if (cached && (!dirty || BACKGROUND_STREAMED)) {
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (fb) {
+      memcpy(gbitmap_get_data(fb), s_scene_cache, s_scene_cache_size);
+      graphics_release_frame_buffer(ctx, fb);
+      if (!dirty) {
+        return;
       }
-    } else {
-      // Angel going back up
-      s_game.angel.y -= ANGEL_SPEED * dt;
-      
-      // Check if angel exited the screen
-      if (s_game.angel.y < 0.0f) {
-        s_game.angel.active = false;
+    }
+#if BACKGROUND_STREAMED
+    // Repaint only the damaged rows over the restored scene, then save them
+    int top = s_scene_dirty_top < 0 ? 0 : s_scene_dirty_top;
+    int bottom = s_scene_dirty_bottom;
+    stream_background_rows(ctx, top, bottom);
+    draw_blocks(ctx);
+    fb = graphics_capture_frame_buffer(ctx);
+    if (fb) {
+      int fb_stride = gbitmap_get_bytes_per_row(fb);
+      size_t start = (size_t)top * fb_stride;
+      size_t end = (size_t)bottom * fb_stride;
+      if (end > s_scene_cache_size) {
+        end = s_scene_cache_size;
       }
+      if (start < end) {
+        memcpy(s_scene_cache + start, gbitmap_get_data(fb) + start, end - start);
+      }
+      s_scene_dirty_top = 0;
+      s_scene_dirty_bottom = 0;
+      graphics_release_frame_buffer(ctx, fb);
     }
+    return;
+#endif
   }
-  
-  // Spawn new beans
-  s_game.bean_spawn_timer += dt;
-  if (s_game.bean_spawn_timer >= BEAN_SPAWN_FREQUENCY / s_physics_speed) {
-    spawn_bean();
-    s_game.bean_spawn_timer = 0.0f;
+  draw_background(ctx, bounds);
+  draw_blocks(ctx);
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return;
   }
-  
-  // Update score display
-  static char score_text[20];
-  snprintf(score_text, sizeof(score_text), "Score: %d", s_game.score);
-  text_layer_set_text(s_score_layer, score_text);
-  
-  // Advance background slowly as score increases (only when playing)
-  if (s_game.state == GAME_STATE_PLAYING) {
-    int new_bg = s_game.score / SCORE_PER_BACKGROUND;
-    if (new_bg >= NUM_BACKGROUNDS) {
-      new_bg = NUM_BACKGROUNDS - 1;
-    }
-    if (new_bg != s_background_index) {
-      s_background_index = new_bg;
-      if (s_background_bitmap) {
-        gbitmap_destroy(s_background_bitmap);
-        s_background_bitmap = NULL;
-      }
-      s_background_bitmap = gbitmap_create_with_resource(s_background_resource_ids[s_background_index]);
+  if (cached) {
+    memcpy(s_scene_cache, gbitmap_get_data(fb), s_scene_cache_size);
+    s_scene_dirty_top = 0;
+    s_scene_dirty_bottom = 0;
+  }
+#if defined(PBL_COLOR)
+  build_cloud_strips(fb);
+#endif
+  graphics_release_frame_buffer(ctx, fb);
+}
+
+#if defined(PBL_COLOR)
+// Copy the strip rows back at the current scroll offset: per row, the two
+// halves on either side of the wrap point
+static void draw_cloud_strips(GContext *ctx) {
+  if (!s_clouds_ready || s_battery_saver || s_watchdog.level >= SHED_EFFECTS) {
+    return;
+  }
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return;
+  }
+  float seconds = (s_game.ticks + s_interp_alpha / 256.0f) * SIM_DT;
+  for (int i = 0; i < CLOUD_STRIPS; i++) {
+    const CloudStrip *strip = &s_cloud_strips[i];
+    int scroll = (int)(seconds * strip->speed);
+    for (int r = 0; r < strip->rows; r++) {
+      GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, strip->top + r);
+      int width = info.max_x - info.min_x + 1;
+      const uint8_t *src = s_cloud_pixels[i][r];
+      int offset = scroll % width;
+      memcpy(info.data + info.min_x, src + offset, width - offset);
+      memcpy(info.data + info.min_x + width - offset, src, offset);
     }
   }
-  
-  layer_mark_dirty(s_game_layer);
+  graphics_release_frame_buffer(ctx, fb);
 }
+#endif
 
-// Render game
-static void game_layer_update_callback(Layer *layer, GContext *ctx) {
-  GRect bounds = layer_get_bounds(layer);
+// Benchmark results: rates over the run and per-tick / per-frame costs
+static void draw_benchmark_results(GContext *ctx, GRect bounds) {
   int screen_width = bounds.size.w;
   int screen_height = bounds.size.h;
-  
-  // Calculate scaling
-  int game_pixel_width = screen_width;
-  int game_pixel_height = screen_height - 20; // Reserve space for score
-  float scale_x = (float)game_pixel_width / GAME_WIDTH;
-  float scale_y = (float)game_pixel_height / GAME_HEIGHT;
-  
-  // Draw background
-  if (s_background_bitmap) {
-    graphics_draw_bitmap_in_rect(ctx, s_background_bitmap, bounds);
-  } else {
-    graphics_context_set_fill_color(ctx, GColorBlack);
-    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-  }
+  graphics_context_set_fill_color(ctx, GColorBlack);
+  graphics_fill_rect(ctx, GRect(2, 2, screen_width - 4, screen_height - 4), 4, GCornerNone);
+  graphics_context_set_text_color(ctx, GColorWhite);
+  graphics_draw_text(ctx, "BENCHMARK", fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                    GRect(0, 2, screen_width, 20),
+                    GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+
+  // Rates in tenths per second and costs in microseconds (no %f in the Pebble libc)
+  static char results_buf[160];
+  uint32_t elapsed = s_benchmark.elapsed_ms ? s_benchmark.elapsed_ms : 1;
+  uint32_t ticks = s_benchmark.ticks ? s_benchmark.ticks : 1;
+  uint32_t frames = s_benchmark.frames ? s_benchmark.frames : 1;
+  uint32_t tps_x10 = s_benchmark.ticks * 10000 / elapsed;
+  uint32_t fps_x10 = s_benchmark.frames * 10000 / elapsed;
+  snprintf(results_buf, sizeof(results_buf),
+           "Ticks/s %lu.%lu\nFrames/s %lu.%lu\nUpdate avg %luus max %lums\n"
+           "Draw avg %luus max %lums\nHeap peak %lu B",
+           (unsigned long)(tps_x10 / 10), (unsigned long)(tps_x10 % 10),
+           (unsigned long)(fps_x10 / 10), (unsigned long)(fps_x10 % 10),
+           (unsigned long)(s_benchmark.update_ms_total * 1000 / ticks),
+           (unsigned long)s_benchmark.update_ms_max,
+           (unsigned long)(s_benchmark.draw_ms_total * 1000 / frames),
+           (unsigned long)s_benchmark.draw_ms_max,
+           (unsigned long)s_benchmark.heap_high_water);
+  graphics_draw_text(ctx, results_buf, fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                    GRect(6, 24, screen_width - 12, screen_height - 48),
+                    GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+  graphics_draw_text(ctx, "SELECT: menu", fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                    GRect(0, screen_height - 20, screen_width, 16),
+                    GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
+
+// Render game
+static void draw_game(GContext *ctx) {
+  GRect bounds = s_layout.bounds;
+  int screen_width = s_layout.screen_width;
+  int screen_height = s_layout.screen_height;
+  int game_pixel_width = s_layout.game_pixel_width;
+  int game_pixel_height = s_layout.game_pixel_height;
+  float scale_x = s_layout.scale_x;
+  float scale_y = s_layout.scale_y;
   
   if (s_game.state == GAME_STATE_MENU) {
+    draw_background(ctx, bounds);
     graphics_context_set_text_color(ctx, GColorWhite);
     graphics_draw_text(ctx, "PYORO", fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD),
                       GRect(0, screen_height/2 - 20, screen_width, 30),
@@ -563,32 +2866,52 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     graphics_draw_text(ctx, "Press SELECT", fonts_get_system_font(FONT_KEY_GOTHIC_18),
                       GRect(0, screen_height/2 + 10, screen_width, 20),
                       GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+    graphics_draw_text(ctx, "UP: swarm  DOWN: stats", fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                      GRect(0, screen_height/2 + 32, screen_width, 18),
+                      GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+    graphics_draw_text(ctx, "Hold UP: waves", fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                      GRect(0, screen_height/2 + 48, screen_width, 18),
+                      GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
     return;
   }
-  
-  if (s_game.state == GAME_STATE_GAME_OVER) {
-    // Fall through to draw game scene, then overlay at end
+
+  if (s_game.state == GAME_STATE_STATS) {
+    draw_background(ctx, bounds);
+    draw_stats_screen(ctx, bounds);
+    return;
   }
 
-  // Draw blocks
-  for (int i = 0; i < GAME_WIDTH; i++) {
-    if (s_game.blocks[i].exists) {
-      int x = (int)(i * scale_x);
-      // Draw blocks at the bottom of the game area (accounting for score layer)
-      int y = 20 + (int)((GAME_HEIGHT - 1) * scale_y);
-      int w = (int)scale_x;
-      int h = (int)scale_y;
-      GRect block_rect = GRect(x, y, w, h);
-      if (s_block_bitmap) {
-        graphics_draw_bitmap_in_rect(ctx, s_block_bitmap, block_rect);
-      } else {
-        // Fallback to gray rectangle if bitmap not loaded
-        graphics_context_set_fill_color(ctx, GColorDarkGray);
-        graphics_fill_rect(ctx, block_rect, 0, GCornerNone);
-      }
-    }
+  if (s_game.state == GAME_STATE_BENCHMARK) {
+    draw_background(ctx, bounds);
+    draw_benchmark_results(ctx, bounds);
+    return;
+  }
+
+  if (s_game.state == GAME_STATE_FLIGHT) {
+    draw_background(ctx, bounds);
+    draw_flight_screen(ctx, bounds);
+    return;
   }
   
+  // Playing or game over: static scene, then sprites, then the overlay at end
+  TRACE_BEGIN(TRACE_DRAW_SCENE);
+  draw_static_scene(ctx, bounds);
+#if defined(PBL_COLOR)
+  draw_cloud_strips(ctx);
+#endif
+  TRACE_END(TRACE_DRAW_SCENE);
+  TRACE_BEGIN(TRACE_DRAW_SPRITES);
+  
+  // Interpolated Pyoro (the tongue extension is interpolated within one shot)
+  Pyoro pyoro_view = s_game.pyoro;
+  if (s_prev_game.pyoro.tongue.active && s_game.pyoro.tongue.active &&
+      s_prev_game.pyoro.tongue.start_x == s_game.pyoro.tongue.start_x) {
+    int prev_ext = s_prev_game.pyoro.tongue.ext;
+    pyoro_view.tongue.ext = prev_ext + (s_game.pyoro.tongue.ext - prev_ext) * s_interp_alpha / 256;
+  }
+  float pyoro_x = interp_position(s_prev_game.pyoro.x, s_game.pyoro.x);
+  float pyoro_y_units = FX_TO_FLOAT(s_game.pyoro.y);
+
   // Draw Pyoro
   if (!s_game.pyoro.dead) {
     // Select sprite based on tongue state and direction
@@ -612,8 +2935,8 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     
     if (pyoro_bitmap) {
       // Calculate desired center position
-      int pyoro_center_x = (int)(s_game.pyoro.x * scale_x);
-      int pyoro_center_y = 20 + (int)(s_game.pyoro.y * scale_y);
+      int pyoro_center_x = (int)(pyoro_x * scale_x);
+      int pyoro_center_y = 20 + (int)(pyoro_y_units * scale_y);
       
       // Get bitmap size
       GRect bitmap_bounds = gbitmap_get_bounds(pyoro_bitmap);
@@ -642,8 +2965,8 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     
     if (death_bitmap) {
       // Calculate desired center position
-      int pyoro_center_x = (int)(s_game.pyoro.x * scale_x);
-      int pyoro_center_y = 20 + (int)(s_game.pyoro.y * scale_y);
+      int pyoro_center_x = (int)(pyoro_x * scale_x);
+      int pyoro_center_y = 20 + (int)(pyoro_y_units * scale_y);
       
       // Get bitmap size
       GRect bitmap_bounds = gbitmap_get_bounds(death_bitmap);
@@ -662,52 +2985,37 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     } else {
       // Fallback to red rectangle if death bitmap not loaded
       graphics_context_set_fill_color(ctx, GColorRed);
-      int pyoro_x = (int)((s_game.pyoro.x - PYORO_SIZE/2.0f) * scale_x);
-      int pyoro_y = 20 + (int)((s_game.pyoro.y - PYORO_SIZE/2.0f) * scale_y);
-      int pyoro_w = (int)(PYORO_SIZE * scale_x);
-      int pyoro_h = (int)(PYORO_SIZE * scale_y);
-      graphics_fill_rect(ctx, GRect(pyoro_x, pyoro_y, pyoro_w, pyoro_h), 0, GCornerNone);
+      int rect_x = (int)((pyoro_x - PYORO_SIZE/2.0f) * scale_x);
+      int rect_y = 20 + (int)((pyoro_y_units - PYORO_SIZE/2.0f) * scale_y);
+      int rect_w = (int)(PYORO_SIZE * scale_x);
+      int rect_h = (int)(PYORO_SIZE * scale_y);
+      graphics_fill_rect(ctx, GRect(rect_x, rect_y, rect_w, rect_h), 0, GCornerNone);
     }
   } else {
     // Fallback to red rectangle if bitmap not loaded
     graphics_context_set_fill_color(ctx, GColorRed);
-    int pyoro_x = (int)((s_game.pyoro.x - PYORO_SIZE/2.0f) * scale_x);
-    int pyoro_y = 20 + (int)((s_game.pyoro.y - PYORO_SIZE/2.0f) * scale_y);
-    int pyoro_w = (int)(PYORO_SIZE * scale_x);
-    int pyoro_h = (int)(PYORO_SIZE * scale_y);
-    graphics_fill_rect(ctx, GRect(pyoro_x, pyoro_y, pyoro_w, pyoro_h), 0, GCornerNone);
+    int rect_x = (int)((pyoro_x - PYORO_SIZE/2.0f) * scale_x);
+    int rect_y = 20 + (int)((pyoro_y_units - PYORO_SIZE/2.0f) * scale_y);
+    int rect_w = (int)(PYORO_SIZE * scale_x);
+    int rect_h = (int)(PYORO_SIZE * scale_y);
+    graphics_fill_rect(ctx, GRect(rect_x, rect_y, rect_w, rect_h), 0, GCornerNone);
   }
   
   // Draw tongue
   if (s_game.pyoro.tongue.active) {
-    // Calculate tongue start position (where it leaves the bird)
-    // Use PYORO_VISUAL_SIZE for positioning to match the actual sprite size
-    float tongue_start_x = s_game.pyoro.x + (PYORO_VISUAL_SIZE/2.0f + 0.6f) * s_game.pyoro.direction;
-    float tongue_start_y = s_game.pyoro.y - PYORO_VISUAL_SIZE/2.0f + 0.6f;
-    
-    // Calculate tip position
-    float tongue_tip_x = s_game.pyoro.tongue.x;
-    float tongue_tip_y = s_game.pyoro.tongue.y;
-    
-    // Calculate distance and direction from start to tip
-    float dx = tongue_tip_x - tongue_start_x;
-    float dy = tongue_tip_y - tongue_start_y;
-    float distance_sq = dx * dx + dy * dy;
-    float distance = 0.0f;
-    if (distance_sq > 0.01f) {
-      // Simple approximation: distance ≈ max(|dx|, |dy|) + 0.4 * min(|dx|, |dy|)
-      // This avoids sqrtf which has linker issues
-      float adx = dx < 0 ? -dx : dx;
-      float ady = dy < 0 ? -dy : dy;
-      float max_abs = adx > ady ? adx : ady;
-      float min_abs = adx < ady ? adx : ady;
-      distance = max_abs + 0.4f * min_abs;
-    }
+    const Pyoro *pyoro = &pyoro_view;
+    int ext = pyoro->tongue.ext;
+    int dir = pyoro->tongue.direction;
+    // Fixed-point game units -> pixels (integer only)
+    const int fx_width = GAME_WIDTH << FX_SHIFT;
+    const int fx_height = GAME_HEIGHT << FX_SHIFT;
+    int tip_px_x = tongue_tip_x_fx(pyoro) * game_pixel_width / fx_width;
+    int tip_px_y = 20 + tongue_tip_y_fx(pyoro) * game_pixel_height / fx_height;
     
     // Select body and tip bitmaps based on direction (1 = right, -1 = left)
     GBitmap *tongue_body_bitmap = NULL;
     GBitmap *tongue_tip_bitmap = NULL;
-    if (s_game.pyoro.tongue.direction == 1) {
+    if (dir == 1) {
       tongue_body_bitmap = s_tongue_body_right_bitmap;
       tongue_tip_bitmap = s_tongue_bitmap;
     } else {
@@ -718,7 +3026,7 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     // Set compositing mode to respect alpha channel/transparency
     graphics_context_set_compositing_mode(ctx, GCompOpSet);
     
-    if (tongue_body_bitmap && distance > 0.05f) {
+    if (tongue_body_bitmap && ext > 0 && s_watchdog.level < SHED_TONGUE_BODY) {
       // Get body bitmap size (in pixels)
       GRect body_bounds = gbitmap_get_bounds(tongue_body_bitmap);
       int body_width_px = body_bounds.size.w;
@@ -731,57 +3039,34 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
         tip_width_px = tip_bounds.size.w;
       }
       
-      // Convert to game coordinates for spacing calculations
-      float body_width_game = (float)body_width_px / scale_x;
-      float tip_width_game = (float)tip_width_px / scale_x;
-      
-      // Calculate how many body segments we need
-      // Leave a small gap before the tip (about 1/3 of tip width)
-      float body_distance = distance - tip_width_game * 0.33f;
-      if (body_distance < body_width_game * 0.5f) {
-        // If distance is very small, still draw at least one segment if we have room
-        body_distance = distance * 0.7f; // Use 70% of distance for body
+      // Segments overlap slightly along the diagonal: two thirds of the body
+      // width per step on the x axis, converted to lattice units
+      int step_ext = (body_width_px * 2 / 3) * fx_width / game_pixel_width;
+      if (step_ext < 1) {
+        step_ext = 1;
       }
-      
-      // Always draw at least one segment if distance is significant
-      int num_segments = (int)(body_distance / body_width_game);
-      if (num_segments < 1 && distance > body_width_game * 0.3f) {
-        num_segments = 1;
+      // Leave a small gap before the tip (about a quarter of its width)
+      int body_ext = ext - (tip_width_px / 4) * fx_width / game_pixel_width;
+      if (body_ext < step_ext * 3 / 4) {
+        body_ext = ext * 7 / 10; // Very short tongue: still show some body
       }
-      num_segments += 1; // Add one more to ensure full coverage
       
-      // Normalize direction vector
-      if (distance > 0.01f) {
-        float inv_distance = 1.0f / distance;
-        float dir_x = dx * inv_distance;
-        float dir_y = dy * inv_distance;
-        
-        // Step slightly less than full width so segments overlap and close any gap
-        float step_game = body_width_game * 0.94f;
-        
-        // Draw body segments from start towards tip
-        for (int i = 0; i < num_segments; i++) {
-          float segment_pos = (float)i * step_game;
-          if (segment_pos >= body_distance) {
-            break;
-          }
-          float seg_x = tongue_start_x + dir_x * segment_pos;
-          float seg_y = tongue_start_y + dir_y * segment_pos;
-          int seg_screen_x = (int)(seg_x * scale_x + 0.5f) - body_width_px / 2;
-          int seg_screen_y = 20 + (int)(seg_y * scale_y + 0.5f) - body_height_px / 2 + 3;
-          GRect body_rect = GRect(seg_screen_x, seg_screen_y, body_width_px, body_height_px);
-          graphics_draw_bitmap_in_rect(ctx, tongue_body_bitmap, body_rect);
-        }
+      // Draw body segments from start towards tip
+      for (int seg_ext = 0; seg_ext < body_ext; seg_ext += step_ext) {
+        int seg_x = pyoro->tongue.start_x + dir * seg_ext;
+        int seg_y = pyoro->tongue.start_y - seg_ext;
+        int seg_screen_x = seg_x * game_pixel_width / fx_width - body_width_px / 2;
+        int seg_screen_y = 20 + seg_y * game_pixel_height / fx_height - body_height_px / 2 + 3;
+        GRect body_rect = GRect(seg_screen_x, seg_screen_y, body_width_px, body_height_px);
+        graphics_draw_bitmap_in_rect(ctx, tongue_body_bitmap, body_rect);
       }
     }
     
     // Draw tongue tip at the end
     if (tongue_tip_bitmap) {
       GRect tip_bounds = gbitmap_get_bounds(tongue_tip_bitmap);
-      int tip_center_x = (int)(tongue_tip_x * scale_x);
-      int tip_center_y = 20 + (int)(tongue_tip_y * scale_y);
-      int tip_x = tip_center_x - tip_bounds.size.w / 2;
-      int tip_y = tip_center_y - tip_bounds.size.h / 2;
+      int tip_x = tip_px_x - tip_bounds.size.w / 2;
+      int tip_y = tip_px_y - tip_bounds.size.h / 2;
       GRect tip_rect = GRect(tip_x, tip_y, tip_bounds.size.w, tip_bounds.size.h);
       graphics_draw_bitmap_in_rect(ctx, tongue_tip_bitmap, tip_rect);
     }
@@ -793,54 +3078,35 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     if (!tongue_body_bitmap && !tongue_tip_bitmap) {
       // Fallback to yellow rectangle if bitmap not loaded
       graphics_context_set_fill_color(ctx, GColorYellow);
-      int tongue_x = (int)((s_game.pyoro.tongue.x - TONGUE_WIDTH/2.0f) * scale_x);
-      int tongue_y = 20 + (int)((s_game.pyoro.tongue.y - TONGUE_WIDTH/2.0f) * scale_y);
       int tongue_w = (int)(TONGUE_WIDTH * scale_x);
       int tongue_h = (int)(TONGUE_WIDTH * scale_y);
-      graphics_fill_rect(ctx, GRect(tongue_x, tongue_y, tongue_w, tongue_h), 0, GCornerNone);
+      graphics_fill_rect(ctx, GRect(tip_px_x - tongue_w / 2, tip_px_y - tongue_h / 2, tongue_w, tongue_h),
+                         0, GCornerNone);
     }
   }
   
   // Draw beans
-  for (int i = 0; i < 5; i++) {
+  for (int i = 0; i < MAX_BEANS; i++) {
     if (s_game.beans[i].active) {
+      float bean_x = FX_TO_FLOAT(s_game.beans[i].x);
+      float bean_y = FX_TO_FLOAT(s_game.beans[i].y);
+      if (s_prev_game.beans[i].active) {
+        bean_x = interp_position(s_prev_game.beans[i].x, s_game.beans[i].x);
+        bean_y = interp_position(s_prev_game.beans[i].y, s_game.beans[i].y);
+      }
       // Calculate animation frame based on frame count and bean index
       // This creates a staggered animation effect for multiple beans
-      int animation_frame = (s_frame_count / BEAN_ANIMATION_SPEED + i) % 3;
+      uint32_t animation_ticks = s_watchdog.level >= SHED_BEAN_ANIMATION ?
+                                 s_watchdog.bean_animation_ticks : s_game.ticks;
+      int animation_frame = (animation_ticks / BEAN_ANIMATION_SPEED + i) % BEAN_ANIMATION_FRAMES;
       
-      GBitmap *bean_bitmap = NULL;
-      if (s_game.beans[i].type == BEAN_TYPE_PINK) {
-        // Pink bean animation
-        switch (animation_frame) {
-          case 0:
-            bean_bitmap = s_pink_bean_left_bitmap;
-            break;
-          case 1:
-            bean_bitmap = s_pink_bean_middle_bitmap;
-            break;
-          case 2:
-            bean_bitmap = s_pink_bean_right_bitmap;
-            break;
-        }
-      } else {
-        // Green bean animation
-        switch (animation_frame) {
-          case 0:
-            bean_bitmap = s_green_bean_left_bitmap;
-            break;
-          case 1:
-            bean_bitmap = s_green_bean_middle_bitmap;
-            break;
-          case 2:
-            bean_bitmap = s_green_bean_right_bitmap;
-            break;
-        }
-      }
+      const BeanTypeInfo *info = &BEAN_TYPES[s_game.beans[i].type];
+      GBitmap *bean_bitmap = s_bean_bitmaps[s_game.beans[i].type][animation_frame];
       
       if (bean_bitmap) {
         // Calculate bean center position
-        int bean_center_x = (int)(s_game.beans[i].x * scale_x);
-        int bean_center_y = 20 + (int)(s_game.beans[i].y * scale_y);
+        int bean_center_x = (int)(bean_x * scale_x);
+        int bean_center_y = 20 + (int)(bean_y * scale_y);
         
         // Get bitmap size
         GRect bitmap_bounds = gbitmap_get_bounds(bean_bitmap);
@@ -856,21 +3122,29 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
         graphics_context_set_compositing_mode(ctx, GCompOpAssign);
       } else {
         // Fallback to colored rectangle if bitmap not loaded
-        graphics_context_set_fill_color(ctx, s_game.beans[i].type == BEAN_TYPE_PINK ? GColorFolly : GColorGreen);
-        int bean_x = (int)((s_game.beans[i].x - BEAN_SIZE/2.0f) * scale_x);
-        int bean_y = 20 + (int)((s_game.beans[i].y - BEAN_SIZE/2.0f) * scale_y);
-        int bean_w = (int)(BEAN_SIZE * scale_x);
-        int bean_h = (int)(BEAN_SIZE * scale_y);
-        graphics_fill_rect(ctx, GRect(bean_x, bean_y, bean_w, bean_h), 0, GCornerNone);
+        graphics_context_set_fill_color(ctx, (GColor){ .argb = info->fallback_argb });
+        int rect_x = (int)((bean_x - BEAN_SIZE/2.0f) * scale_x);
+        int rect_y = 20 + (int)((bean_y - BEAN_SIZE/2.0f) * scale_y);
+        int rect_w = (int)(BEAN_SIZE * scale_x);
+        int rect_h = (int)(BEAN_SIZE * scale_y);
+        graphics_fill_rect(ctx, GRect(rect_x, rect_y, rect_w, rect_h), 0, GCornerNone);
       }
     }
   }
   
-  // Draw angel
-  if (s_game.angel.active) {
+  // Draw angels
+  for (int a = 0; a < MAX_ANGELS; a++) {
+    if (!s_game.angels[a].active) {
+      continue;
+    }
+    float angel_x = FX_TO_FLOAT(s_game.angels[a].x);
+    float angel_y = FX_TO_FLOAT(s_game.angels[a].y);
+    if (s_prev_game.angels[a].active) {
+      angel_y = interp_position(s_prev_game.angels[a].y, s_game.angels[a].y);
+    }
     if (s_angel_bitmap) {
-      int angel_center_x = (int)(s_game.angel.x * scale_x);
-      int angel_center_y = 20 + (int)(s_game.angel.y * scale_y);
+      int angel_center_x = (int)(angel_x * scale_x);
+      int angel_center_y = 20 + (int)(angel_y * scale_y);
       
       GRect bitmap_bounds = gbitmap_get_bounds(s_angel_bitmap);
       int bitmap_x = angel_center_x - bitmap_bounds.size.w / 2;
@@ -883,25 +3157,29 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
     } else {
       // Fallback to white rectangle if bitmap not loaded
       graphics_context_set_fill_color(ctx, GColorWhite);
-      int angel_x = (int)((s_game.angel.x - BEAN_SIZE/2.0f) * scale_x);
-      int angel_y = 20 + (int)((s_game.angel.y - BEAN_SIZE/2.0f) * scale_y);
-      int angel_w = (int)(BEAN_SIZE * scale_x);
-      int angel_h = (int)(BEAN_SIZE * scale_y);
-      graphics_fill_rect(ctx, GRect(angel_x, angel_y, angel_w, angel_h), 0, GCornerNone);
+      int rect_x = (int)((angel_x - BEAN_SIZE/2.0f) * scale_x);
+      int rect_y = 20 + (int)((angel_y - BEAN_SIZE/2.0f) * scale_y);
+      int rect_w = (int)(BEAN_SIZE * scale_x);
+      int rect_h = (int)(BEAN_SIZE * scale_y);
+      graphics_fill_rect(ctx, GRect(rect_x, rect_y, rect_w, rect_h), 0, GCornerNone);
     }
   }
 
+  TRACE_END(TRACE_DRAW_SPRITES);
+
   // Game over overlay: top 10 scores + your score, drawn on top of the game
   if (s_game.state == GAME_STATE_GAME_OVER) {
+    TRACE_BEGIN(TRACE_DRAW_OVERLAY);
     graphics_context_set_fill_color(ctx, GColorBlack);
     graphics_fill_rect(ctx, GRect(2, 18, screen_width - 4, screen_height - 22), 4, GCornerNone);
     graphics_context_set_text_color(ctx, GColorWhite);
     graphics_draw_text(ctx, "GAME OVER", fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD),
                       GRect(0, 22, screen_width, 28),
                       GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
-    static char your_score_buf[32];
-    snprintf(your_score_buf, sizeof(your_score_buf), "Your score: %d", s_last_game_score);
-    graphics_draw_text(ctx, your_score_buf, fonts_get_system_font(FONT_KEY_GOTHIC_18),
+    if (s_overlay_dirty) {
+      build_game_over_overlay();
+    }
+    graphics_draw_text(ctx, s_overlay_score_buf, fonts_get_system_font(FONT_KEY_GOTHIC_18),
                       GRect(0, 48, screen_width, 22),
                       GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
     graphics_draw_text(ctx, "TOP 10", fonts_get_system_font(FONT_KEY_GOTHIC_18),
@@ -909,91 +3187,362 @@ static void game_layer_update_callback(Layer *layer, GContext *ctx) {
                       GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
     int y = 86;
     const int line_h = 12;
-    for (int i = 0; i < NUM_HIGH_SCORES; i++) {
-      static char line_buf[24];
-      if (s_high_scores[i] == HIGH_SCORE_EMPTY) {
-        snprintf(line_buf, sizeof(line_buf), "%2d. ---", i + 1);
-      } else {
-        snprintf(line_buf, sizeof(line_buf), "%2d. %d", i + 1, s_high_scores[i]);
-      }
-      if (s_high_scores[i] == s_last_game_score && s_last_game_score != HIGH_SCORE_EMPTY) {
+    for (int i = 0; i < HIGH_SCORES_SHOWN; i++) {
+      if (i == s_overlay_highlight_line) {
         graphics_context_set_text_color(ctx, GColorYellow);
       }
-      graphics_draw_text(ctx, line_buf, fonts_get_system_font(FONT_KEY_GOTHIC_14),
+      graphics_draw_text(ctx, s_overlay_lines[i], fonts_get_system_font(FONT_KEY_GOTHIC_14),
                         GRect(10, y, screen_width - 20, line_h),
                         GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
-      graphics_context_set_text_color(ctx, GColorWhite);
+      if (i == s_overlay_highlight_line) {
+        graphics_context_set_text_color(ctx, GColorWhite);
+      }
       y += line_h;
     }
-    graphics_draw_text(ctx, "SELECT: menu", fonts_get_system_font(FONT_KEY_GOTHIC_14),
+    graphics_draw_text(ctx, "SELECT: menu  Hold: retry", fonts_get_system_font(FONT_KEY_GOTHIC_14),
                       GRect(0, screen_height - 18, screen_width, 18),
                       GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+    TRACE_END(TRACE_DRAW_OVERLAY);
+  }
+}
+
+// Add one frame's update plus draw cost to the window and shed or restore a pass
+static void watchdog_record_frame(uint32_t update_ms) {
+  uint32_t cost = update_ms + s_watchdog.last_draw_ms;
+  if (cost > UINT16_MAX / WATCHDOG_WINDOW) {
+    cost = UINT16_MAX / WATCHDOG_WINDOW;
+  }
+  s_watchdog.window_ms += cost - s_watchdog.cost_ms[s_watchdog.next];
+  s_watchdog.cost_ms[s_watchdog.next] = cost;
+  s_watchdog.next = (s_watchdog.next + 1) % WATCHDOG_WINDOW;
+  if (s_watchdog.level < SHED_BEAN_ANIMATION) {
+    s_watchdog.bean_animation_ticks = s_game.ticks;
+  }
+  if (++s_watchdog.frames_since_change < WATCHDOG_WINDOW) {
+    return;
+  }
+  if (s_watchdog.window_ms > WATCHDOG_WINDOW * WATCHDOG_BUDGET_MS) {
+    if (s_watchdog.level < SHED_MAX) {
+      s_watchdog.level++;
+      s_watchdog.frames_since_change = 0;
+    }
+  } else if (s_watchdog.window_ms * 100 < WATCHDOG_WINDOW * WATCHDOG_BUDGET_MS * WATCHDOG_RESTORE_PERCENT) {
+    if (s_watchdog.level > SHED_NONE) {
+      s_watchdog.level--;
+      s_watchdog.frames_since_change = 0;
+      s_watchdog.defer_scene = false;
+    }
+  }
+}
+
+static void game_layer_update_callback(Layer *layer, GContext *ctx) {
+  if (s_game.state != GAME_STATE_PLAYING) {
+    draw_game(ctx);
+    return;
+  }
+  uint32_t start = wall_ms();
+  TRACE_BEGIN(TRACE_DRAW);
+  draw_game(ctx);
+  TRACE_END(TRACE_DRAW);
+  uint32_t draw_ms = wall_ms() - start;
+  s_watchdog.last_draw_ms = draw_ms;
+  if (!s_game.benchmark) {
+    return;
+  }
+  s_benchmark.frames++;
+  s_benchmark.draw_ms_total += draw_ms;
+  if (draw_ms > s_benchmark.draw_ms_max) {
+    s_benchmark.draw_ms_max = draw_ms;
+  }
+}
+
+// Benchmark pacing: exactly one tick per timer callback, as fast as the
+// event loop allows, timing each tick and sampling the heap
+static void benchmark_update(void) {
+  uint32_t start = wall_ms();
+  s_prev_game = s_game;
+  TRACE_BEGIN(TRACE_UPDATE);
+  update_game(SIM_DT);
+  TRACE_END(TRACE_UPDATE);
+  uint32_t now = wall_ms();
+  uint32_t update_ms = now - start;
+  s_benchmark.ticks++;
+  s_benchmark.update_ms_total += update_ms;
+  if (update_ms > s_benchmark.update_ms_max) {
+    s_benchmark.update_ms_max = update_ms;
   }
+  if (heap_bytes_used() > s_benchmark.heap_high_water) {
+    s_benchmark.heap_high_water = heap_bytes_used();
+  }
+  s_interp_alpha = 256;
+  s_benchmark.elapsed_ms = now - s_benchmark.start_ms;
+  if (s_benchmark.elapsed_ms >= BENCHMARK_SECONDS * 1000) {
+    s_game.state = GAME_STATE_BENCHMARK;
+#ifdef TRACE
+    trace_dump();
+#endif
+  } else if (!s_suspend_reasons) {
+    s_game_timer = app_timer_register(1, game_update, NULL);
+  }
+  layer_mark_dirty(s_game_layer);
 }
 
-// Game timer callback
+// Game timer callback: run as many fixed simulation ticks as wall time
+// allows, then redraw with the remainder as the interpolation factor
 static void game_update(void *data) {
-  update_game(0.016f); // ~60 FPS
-  s_game_timer = app_timer_register(16, game_update, NULL);
+  s_game_timer = NULL; // This timer has fired
+  if (s_game.benchmark && s_game.state == GAME_STATE_PLAYING) {
+    benchmark_update();
+    return;
+  }
+  uint32_t now = wall_ms();
+  s_sim_accum_ms += now - s_last_frame_ms;
+  s_last_frame_ms = now;
+  if (s_sim_accum_ms > SIM_TICK_MS * SIM_MAX_TICKS_PER_FRAME) {
+    s_sim_accum_ms = SIM_TICK_MS * SIM_MAX_TICKS_PER_FRAME;
+  }
+  while (s_sim_accum_ms >= SIM_TICK_MS && s_game.state == GAME_STATE_PLAYING) {
+    s_prev_game = s_game;
+    TRACE_BEGIN(TRACE_UPDATE);
+    update_game(SIM_DT);
+    TRACE_END(TRACE_UPDATE);
+    s_sim_accum_ms -= SIM_TICK_MS;
+  }
+  uint32_t update_ms = wall_ms() - now;
+  watchdog_record_frame(update_ms);
+  flight_record_frame(update_ms);
+#ifdef DEBUG_HEAP_GUARD
+  // Everything a run needs is reserved before reset_game returns
+  if (heap_bytes_used() != s_heap_baseline && !s_heap_guard_reported) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Heap changed during run: %d -> %d bytes",
+            (int)s_heap_baseline, (int)heap_bytes_used());
+    s_heap_guard_reported = true;
+  }
+#endif
+  s_interp_alpha = s_sim_accum_ms * 256 / SIM_TICK_MS;
+  // Shedding at the last level repaints damaged scene rows every other frame;
+  // the game over screen always gets a fresh scene
+  s_watchdog.defer_scene = s_watchdog.level >= SHED_HALF_RATE && !s_watchdog.defer_scene &&
+                           s_game.state == GAME_STATE_PLAYING;
+  layer_mark_dirty(s_game_layer);
+  if (s_game.state == GAME_STATE_PLAYING && !s_suspend_reasons) {
+    s_game_timer = app_timer_register(FRAME_MS, game_update, NULL);
+  }
+}
+
+static void start_game_timer(void) {
+  if (!s_game_timer && !s_suspend_reasons) {
+    // Restart the wall clock so time spent stopped is never simulated
+    s_last_frame_ms = wall_ms();
+    s_game_timer = app_timer_register(FRAME_MS, game_update, NULL);
+  }
+}
+
+static void stop_game_timer(void) {
+  if (s_game_timer) {
+    app_timer_cancel(s_game_timer);
+    s_game_timer = NULL;
+  }
+}
+
+// Stop ticking and redrawing while the game can't be seen. The simulation
+// uses a fixed step, so resuming continues from exactly the same state.
+static void set_suspended(uint8_t reason, bool suspended) {
+  uint8_t was = s_suspend_reasons;
+  if (suspended) {
+    s_suspend_reasons |= reason;
+  } else {
+    s_suspend_reasons &= ~reason;
+  }
+  if (!was && s_suspend_reasons) {
+    stop_game_timer();
+  } else if (was && !s_suspend_reasons) {
+    if (s_game.state == GAME_STATE_PLAYING) {
+      start_game_timer();
+    }
+    layer_mark_dirty(s_game_layer);
+  }
+}
+
+static void prv_app_will_focus(bool in_focus) {
+  if (!in_focus) {
+    set_suspended(SUSPEND_FOCUS_LOST, true);
+  }
+}
+
+static void prv_app_did_focus(bool in_focus) {
+  if (in_focus) {
+    set_suspended(SUSPEND_FOCUS_LOST, false);
+  }
 }
 
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+// Suspend a run that was playing on the full screen when something covers it.
+// A run already playing in a covered area just follows the area's changes.
+static void prv_unobstructed_will_change(GRect final_unobstructed_screen_area, void *context) {
+  GRect full = layer_get_bounds(window_get_root_layer(s_window));
+  if (!grect_equal(&final_unobstructed_screen_area, &full) && grect_equal(&s_layout.bounds, &full) &&
+      s_game.state == GAME_STATE_PLAYING) {
+    set_suspended(SUSPEND_OBSTRUCTED, true);
+  }
+}
+
+static void prv_unobstructed_did_change(void *context) {
+  Layer *window_layer = window_get_root_layer(s_window);
+  GRect area = layer_get_unobstructed_bounds(window_layer);
+  if (!grect_equal(&area, &s_layout.bounds)) {
+    update_layout(area);
+    layer_mark_dirty(s_game_layer);
+  }
+  // Covering is suspended from will_change; uncovering resumes here
+  GRect full = layer_get_bounds(window_layer);
+  if (grect_equal(&area, &full)) {
+    set_suspended(SUSPEND_OBSTRUCTED, false);
+  }
+}
+#endif
+
 // Button handlers
 static void prv_select_click_handler(ClickRecognizerRef recognizer, void *context) {
+  s_flight.input |= FLIGHT_INPUT_SELECT;
   if (s_game.state == GAME_STATE_MENU) {
     reset_game();
-    s_game_timer = app_timer_register(16, game_update, NULL);
-  } else if (s_game.state == GAME_STATE_GAME_OVER) {
-    init_game();  // Reset s_physics_speed, score, blocks, etc. for next playthrough
+    start_game_timer();
+  } else if (s_game.state == GAME_STATE_STATS || s_game.state == GAME_STATE_FLIGHT) {
+    if (s_game.state == GAME_STATE_FLIGHT) {
+      // The ring holds the loaded recording; start the live one afresh
+      s_flight.count = 0;
+      s_flight.next = 0;
+    }
+    s_game.state = GAME_STATE_MENU;
+    layer_mark_dirty(s_game_layer);
+  } else if (s_game.state == GAME_STATE_GAME_OVER || s_game.state == GAME_STATE_BENCHMARK) {
+    init_game();  // Reset s_game.speed, score, blocks, etc. for next playthrough
     s_game.state = GAME_STATE_MENU;
+    window_set_click_config_provider(s_window, prv_click_config_provider);
     layer_mark_dirty(s_game_layer);
   } else if (s_game.state == GAME_STATE_PLAYING && !s_game.pyoro.dead) {
     // Extend tongue (clear any pending steps)
     if (!s_game.pyoro.tongue.active) {
-      s_pending_step_count = 0;
-      s_pending_step_dir = 0;
+      replay_record_input(REPLAY_INPUT_SELECT);
+      s_game.pending_step_count = 0;
+      s_game.pending_step_dir = 0;
       s_game.pyoro.moving = false;
-      s_game.pyoro.tongue.active = true;
-      // Use PYORO_VISUAL_SIZE for positioning to match the actual sprite size
-      s_game.pyoro.tongue.x = s_game.pyoro.x + (PYORO_VISUAL_SIZE/2.0f + 0.6f) * s_game.pyoro.direction;
-      s_game.pyoro.tongue.y = s_game.pyoro.y - PYORO_VISUAL_SIZE/2.0f + 0.6f;
-      s_game.pyoro.tongue.direction = s_game.pyoro.direction;
-      s_game.pyoro.tongue.going_back = false;
-      s_game.pyoro.tongue.caught_bean = false;
+      fire_tongue();
+    }
+  }
+}
+
+// Hidden menu entry: start the benchmark run. On game over: retry.
+static void prv_select_long_click_handler(ClickRecognizerRef recognizer, void *context) {
+  s_flight.input |= FLIGHT_INPUT_HOLD;
+  if (s_game.state == GAME_STATE_GAME_OVER) {
+    // Fast retry: reset the simulation in place, same mode, bitmaps stay
+    // resident, and the first tick runs on the very next timer callback
+    bool swarm = s_game.swarm;
+    bool waves = s_game.waves;
+    reset_game();
+    s_game.swarm = swarm;
+    if (waves) {
+      start_wave_mode();
     }
+    s_prev_game = s_game;
+    s_sim_accum_ms = SIM_TICK_MS;
+    start_game_timer();
+    return;
+  }
+  if (s_game.state != GAME_STATE_MENU) {
+    return;
   }
+  reset_game();
+  s_game.seed = BENCHMARK_SEED;
+  game_srand(s_game.seed);
+  s_game.benchmark = true;
+  s_prev_game = s_game;
+  memset(&s_benchmark, 0, sizeof(s_benchmark));
+  s_benchmark.start_ms = wall_ms();
+  s_benchmark.heap_high_water = heap_bytes_used();
+  start_game_timer();
 }
 
 static void prv_up_click_handler(ClickRecognizerRef recognizer, void *context) {
+  s_flight.input |= FLIGHT_INPUT_UP;
+  if (s_game.state == GAME_STATE_MENU) {
+    // Swarm mode: the whole bean pool and several angels at once
+    reset_game();
+    s_game.swarm = true;
+    s_prev_game = s_game;
+    start_game_timer();
+    return;
+  }
   if (s_game.state == GAME_STATE_PLAYING && !s_game.pyoro.dead && !s_game.pyoro.tongue.active) {
+    replay_record_input(REPLAY_INPUT_UP);
     int was_dir = s_game.pyoro.direction;
     s_game.pyoro.direction = -1;
     if (was_dir == 1) {
       // Opposite: turn in place only, no steps
-      s_pending_step_count = 0;
-      s_pending_step_dir = 0;
+      s_game.pending_step_count = 0;
+      s_game.pending_step_dir = 0;
     } else {
-      s_pending_step_dir = -1;
-      s_pending_step_count++;
-      if (s_pending_step_count > PYORO_PENDING_STEPS_MAX) {
-        s_pending_step_count = PYORO_PENDING_STEPS_MAX;
+      s_game.pending_step_dir = -1;
+      s_game.pending_step_count++;
+      if (s_game.pending_step_count > PYORO_PENDING_STEPS_MAX) {
+        s_game.pending_step_count = PYORO_PENDING_STEPS_MAX;
       }
     }
   }
 }
 
+// Hold UP on the menu: wave mode, beans from the wave script
+static void prv_up_long_click_handler(ClickRecognizerRef recognizer, void *context) {
+  s_flight.input |= FLIGHT_INPUT_HOLD;
+  if (s_game.state != GAME_STATE_MENU) {
+    return;
+  }
+  reset_game();
+  start_wave_mode();
+  s_prev_game = s_game;
+  start_game_timer();
+}
+
+// Menu shortcut to the lifetime stats screen
+static bool open_stats_from_menu(void) {
+  if (s_game.state != GAME_STATE_MENU) {
+    return false;
+  }
+  s_game.state = GAME_STATE_STATS;
+  if (replay_load_best()) {
+    replay_dump();
+  }
+  layer_mark_dirty(s_game_layer);
+  return true;
+}
+
 static void prv_down_click_handler(ClickRecognizerRef recognizer, void *context) {
+  s_flight.input |= FLIGHT_INPUT_DOWN;
+  if (open_stats_from_menu()) {
+    return;
+  }
+  if (s_game.state == GAME_STATE_STATS) {
+    flight_load();
+    flight_dump();
+    s_game.state = GAME_STATE_FLIGHT;
+    layer_mark_dirty(s_game_layer);
+    return;
+  }
   if (s_game.state == GAME_STATE_PLAYING && !s_game.pyoro.dead && !s_game.pyoro.tongue.active) {
+    replay_record_input(REPLAY_INPUT_DOWN);
     int was_dir = s_game.pyoro.direction;
     s_game.pyoro.direction = 1;
     if (was_dir == -1) {
       // Opposite: turn in place only, no steps
-      s_pending_step_count = 0;
-      s_pending_step_dir = 0;
+      s_game.pending_step_count = 0;
+      s_game.pending_step_dir = 0;
     } else {
-      s_pending_step_dir = 1;
-      s_pending_step_count++;
-      if (s_pending_step_count > PYORO_PENDING_STEPS_MAX) {
-        s_pending_step_count = PYORO_PENDING_STEPS_MAX;
+      s_game.pending_step_dir = 1;
+      s_game.pending_step_count++;
+      if (s_game.pending_step_count > PYORO_PENDING_STEPS_MAX) {
+        s_game.pending_step_count = PYORO_PENDING_STEPS_MAX;
       }
     }
   }
@@ -1001,33 +3550,38 @@ static void prv_down_click_handler(ClickRecognizerRef recognizer, void *context)
 
 static void prv_up_repeating_click_handler(ClickRecognizerRef recognizer, void *context) {
   if (s_game.state == GAME_STATE_PLAYING && !s_game.pyoro.dead && !s_game.pyoro.tongue.active) {
+    replay_record_input(REPLAY_INPUT_UP_REPEAT);
     int was_dir = s_game.pyoro.direction;
     s_game.pyoro.direction = -1;
     if (was_dir == 1) {
-      s_pending_step_count = 0;
-      s_pending_step_dir = 0;
+      s_game.pending_step_count = 0;
+      s_game.pending_step_dir = 0;
     } else {
-      s_pending_step_dir = -1;
-      s_pending_step_count += 4;
-      if (s_pending_step_count > PYORO_PENDING_STEPS_MAX) {
-        s_pending_step_count = PYORO_PENDING_STEPS_MAX;
+      s_game.pending_step_dir = -1;
+      s_game.pending_step_count += 4;
+      if (s_game.pending_step_count > PYORO_PENDING_STEPS_MAX) {
+        s_game.pending_step_count = PYORO_PENDING_STEPS_MAX;
       }
     }
   }
 }
 
 static void prv_down_repeating_click_handler(ClickRecognizerRef recognizer, void *context) {
+  if (open_stats_from_menu()) {
+    return;
+  }
   if (s_game.state == GAME_STATE_PLAYING && !s_game.pyoro.dead && !s_game.pyoro.tongue.active) {
+    replay_record_input(REPLAY_INPUT_DOWN_REPEAT);
     int was_dir = s_game.pyoro.direction;
     s_game.pyoro.direction = 1;
     if (was_dir == -1) {
-      s_pending_step_count = 0;
-      s_pending_step_dir = 0;
+      s_game.pending_step_count = 0;
+      s_game.pending_step_dir = 0;
     } else {
-      s_pending_step_dir = 1;
-      s_pending_step_count += 4;
-      if (s_pending_step_count > PYORO_PENDING_STEPS_MAX) {
-        s_pending_step_count = PYORO_PENDING_STEPS_MAX;
+      s_game.pending_step_dir = 1;
+      s_game.pending_step_count += 4;
+      if (s_game.pending_step_count > PYORO_PENDING_STEPS_MAX) {
+        s_game.pending_step_count = PYORO_PENDING_STEPS_MAX;
       }
     }
   }
@@ -1035,16 +3589,40 @@ static void prv_down_repeating_click_handler(ClickRecognizerRef recognizer, void
 
 static void prv_click_config_provider(void *context) {
   window_single_click_subscribe(BUTTON_ID_SELECT, prv_select_click_handler);
+  // Only the menu and game over listen for a long press: with one configured,
+  // a single click fires on release, which would delay the tongue in play
+  if (s_game.state == GAME_STATE_MENU || s_game.state == GAME_STATE_GAME_OVER) {
+    window_long_click_subscribe(BUTTON_ID_SELECT, 0, prv_select_long_click_handler, NULL);
+  }
   window_single_click_subscribe(BUTTON_ID_UP, prv_up_click_handler);
-  window_single_repeating_click_subscribe(BUTTON_ID_UP, 100, prv_up_repeating_click_handler);
+  // UP's long press (wave mode) stands in for its repeat, which only walks in play
+  if (s_game.state == GAME_STATE_MENU) {
+    window_long_click_subscribe(BUTTON_ID_UP, 0, prv_up_long_click_handler, NULL);
+  } else {
+    window_single_repeating_click_subscribe(BUTTON_ID_UP, 100, prv_up_repeating_click_handler);
+  }
   window_single_click_subscribe(BUTTON_ID_DOWN, prv_down_click_handler);
   window_single_repeating_click_subscribe(BUTTON_ID_DOWN, 100, prv_down_repeating_click_handler);
 }
 
+#if defined(PBL_COLOR)
+// Low battery: skip the cloud strips, leaving the cached sky rows in place
+static void prv_battery_state_handler(BatteryChargeState state) {
+  s_battery_saver = !state.is_charging && state.charge_percent <= CLOUD_BATTERY_SAVER_PERCENT;
+}
+#endif
+
 static void prv_window_load(Window *window) {
   Layer *window_layer = window_get_root_layer(window);
   GRect bounds = layer_get_bounds(window_layer);
   
+#if PBL_API_EXISTS(layer_get_unobstructed_bounds)
+  // The layout starts in the unobstructed area; nothing is running to suspend
+  update_layout(layer_get_unobstructed_bounds(window_layer));
+#else
+  update_layout(bounds);
+#endif
+
   // Create game layer
   s_game_layer = layer_create(bounds);
   layer_set_update_proc(s_game_layer, game_layer_update_callback);
@@ -1065,8 +3643,13 @@ static void prv_window_load(Window *window) {
   text_layer_set_text_color(s_game_over_layer, GColorWhite);
   layer_add_child(window_layer, text_layer_get_layer(s_game_over_layer));
   
-  // Load background bitmap (first of the cycling set)
-  s_background_bitmap = gbitmap_create_with_resource(s_background_resource_ids[0]);
+  // Load background (first of the cycling set)
+#if BACKGROUND_DECODED
+  s_background_bitmap = gbitmap_create_blank(GSize(BG_DECODED_WIDTH, BG_DECODED_HEIGHT),
+                                             GBitmapFormat8Bit);
+#endif
+  set_background(0);
+  reserve_scene_cache(bounds.size);
   
   // Load Pyoro bitmaps
   s_pyoro_right_bitmap = gbitmap_create_with_resource(RESOURCE_ID_PYORO_RIGHT);
@@ -1088,29 +3671,64 @@ static void prv_window_load(Window *window) {
   s_tongue_body_left_bitmap = gbitmap_create_with_resource(RESOURCE_ID_TONGUE_BODY_LEFT);
   
   // Load bean bitmaps
-  s_green_bean_left_bitmap = gbitmap_create_with_resource(RESOURCE_ID_GREEN_BEAN_LEFT);
-  s_green_bean_middle_bitmap = gbitmap_create_with_resource(RESOURCE_ID_GREEN_BEAN_MIDDLE);
-  s_green_bean_right_bitmap = gbitmap_create_with_resource(RESOURCE_ID_GREEN_BEAN_RIGHT);
-  s_pink_bean_left_bitmap = gbitmap_create_with_resource(RESOURCE_ID_PINK_BEAN_LEFT);
-  s_pink_bean_middle_bitmap = gbitmap_create_with_resource(RESOURCE_ID_PINK_BEAN_MIDDLE);
-  s_pink_bean_right_bitmap = gbitmap_create_with_resource(RESOURCE_ID_PINK_BEAN_RIGHT);
+  for (int type = 0; type < NUM_BEAN_TYPES; type++) {
+    for (int frame = 0; frame < BEAN_ANIMATION_FRAMES; frame++) {
+      s_bean_bitmaps[type][frame] = gbitmap_create_with_resource(BEAN_TYPES[type].sprites[frame]);
+    }
+  }
   
   // Load angel bitmap
   s_angel_bitmap = gbitmap_create_with_resource(RESOURCE_ID_ANGEL);
   
   load_high_scores();
+  load_lifetime_stats();
+  s_flight.previous_crashed = persist_read_bool(PERSIST_KEY_SESSION_OPEN);
+  if (s_flight.previous_crashed) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Previous session did not exit cleanly");
+  }
+  persist_write_bool(PERSIST_KEY_SESSION_OPEN, true);
   init_game();
+#if BACKGROUND_STREAMED && defined(BENCHMARK_BACKGROUND_STREAMING)
+  benchmark_background_streaming();
+#endif
+
+  app_focus_service_subscribe_handlers((AppFocusHandlers) {
+    .will_focus = prv_app_will_focus,
+    .did_focus = prv_app_did_focus,
+  });
+#if defined(PBL_COLOR)
+  prv_battery_state_handler(battery_state_service_peek());
+  battery_state_service_subscribe(prv_battery_state_handler);
+#endif
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+  unobstructed_area_service_subscribe((UnobstructedAreaHandlers) {
+    .will_change = prv_unobstructed_will_change,
+    .did_change = prv_unobstructed_did_change,
+  }, NULL);
+#endif
 }
 
 static void prv_window_unload(Window *window) {
-  if (s_game_timer) {
-    app_timer_cancel(s_game_timer);
-    s_game_timer = NULL;
+  app_focus_service_unsubscribe();
+#if defined(PBL_COLOR)
+  battery_state_service_unsubscribe();
+#endif
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+  unobstructed_area_service_unsubscribe();
+#endif
+  stop_game_timer();
+  if (s_flight.reason != FLIGHT_REASON_NONE) {
+    flight_persist();
   }
+  persist_write_bool(PERSIST_KEY_SESSION_OPEN, false);
   if (s_background_bitmap) {
     gbitmap_destroy(s_background_bitmap);
     s_background_bitmap = NULL;
   }
+  if (s_scene_cache) {
+    free(s_scene_cache);
+    s_scene_cache = NULL;
+  }
   if (s_pyoro_right_bitmap) {
     gbitmap_destroy(s_pyoro_right_bitmap);
     s_pyoro_right_bitmap = NULL;
@@ -1163,29 +3781,13 @@ static void prv_window_unload(Window *window) {
     gbitmap_destroy(s_tongue_body_left_bitmap);
     s_tongue_body_left_bitmap = NULL;
   }
-  if (s_green_bean_left_bitmap) {
-    gbitmap_destroy(s_green_bean_left_bitmap);
-    s_green_bean_left_bitmap = NULL;
-  }
-  if (s_green_bean_middle_bitmap) {
-    gbitmap_destroy(s_green_bean_middle_bitmap);
-    s_green_bean_middle_bitmap = NULL;
-  }
-  if (s_green_bean_right_bitmap) {
-    gbitmap_destroy(s_green_bean_right_bitmap);
-    s_green_bean_right_bitmap = NULL;
-  }
-  if (s_pink_bean_left_bitmap) {
-    gbitmap_destroy(s_pink_bean_left_bitmap);
-    s_pink_bean_left_bitmap = NULL;
-  }
-  if (s_pink_bean_middle_bitmap) {
-    gbitmap_destroy(s_pink_bean_middle_bitmap);
-    s_pink_bean_middle_bitmap = NULL;
-  }
-  if (s_pink_bean_right_bitmap) {
-    gbitmap_destroy(s_pink_bean_right_bitmap);
-    s_pink_bean_right_bitmap = NULL;
+  for (int type = 0; type < NUM_BEAN_TYPES; type++) {
+    for (int frame = 0; frame < BEAN_ANIMATION_FRAMES; frame++) {
+      if (s_bean_bitmaps[type][frame]) {
+        gbitmap_destroy(s_bean_bitmaps[type][frame]);
+        s_bean_bitmaps[type][frame] = NULL;
+      }
+    }
   }
   if (s_angel_bitmap) {
     gbitmap_destroy(s_angel_bitmap);
@@ -1216,4 +3818,5 @@ int main(void) {
   APP_LOG(APP_LOG_LEVEL_DEBUG, "Pyoro game initialized");
   app_event_loop();
   prv_deinit();
+  return 0;
 }
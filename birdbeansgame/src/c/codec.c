@@ -0,0 +1,132 @@
+#include "codec.h"
+
+#include <string.h>
+
+#define CODEC_HASH_BITS 6
+
+static uint32_t hash3(const uint8_t *bytes) {
+  uint32_t word = bytes[0] | bytes[1] << 8 | bytes[2] << 16;
+  return (word * 2654435761u) >> (32 - CODEC_HASH_BITS);
+}
+
+// Flush src[start, end) as literal runs
+static int put_literals(const uint8_t *src, size_t start, size_t end,
+                        uint8_t *dst, size_t out, size_t dst_capacity) {
+  while (start < end) {
+    size_t run = end - start < CODEC_MAX_LITERALS ? end - start : CODEC_MAX_LITERALS;
+    if (out + 1 + run > dst_capacity) {
+      return -1;
+    }
+    dst[out++] = run - 1;
+    memcpy(dst + out, src + start, run);
+    out += run;
+    start += run;
+  }
+  return out;
+}
+
+void codec_split_planes(const void *src_bytes, void *dst_bytes, size_t size, size_t stride) {
+  const uint8_t *src = src_bytes;
+  uint8_t *dst = dst_bytes;
+  size_t elements = size / stride;
+  for (size_t plane = 0; plane < stride; plane++) {
+    for (size_t i = 0; i < elements; i++) {
+      *dst++ = src[i * stride + plane];
+    }
+  }
+  memcpy(dst, src + elements * stride, size - elements * stride);
+}
+
+void codec_merge_planes(const void *src_bytes, void *dst_bytes, size_t size, size_t stride) {
+  const uint8_t *src = src_bytes;
+  uint8_t *dst = dst_bytes;
+  size_t elements = size / stride;
+  for (size_t plane = 0; plane < stride; plane++) {
+    for (size_t i = 0; i < elements; i++) {
+      dst[i * stride + plane] = *src++;
+    }
+  }
+  memcpy(dst + elements * stride, src, size - elements * stride);
+}
+
+int codec_compress(const void *src_bytes, size_t src_size, void *dst_bytes, size_t dst_capacity) {
+  const uint8_t *src = src_bytes;
+  uint8_t *dst = dst_bytes;
+  // Last position + 1 where each 3-byte hash was seen (0: never)
+  uint16_t head[1 << CODEC_HASH_BITS];
+  memset(head, 0, sizeof(head));
+  if (src_size > UINT16_MAX) {
+    return -1;
+  }
+  size_t out = 0;
+  size_t literal_start = 0;
+  size_t pos = 0;
+  while (pos < src_size) {
+    size_t match_length = 0;
+    size_t match_distance = 0;
+    if (pos + CODEC_MIN_MATCH <= src_size) {
+      uint32_t hash = hash3(src + pos);
+      size_t candidate = head[hash];
+      head[hash] = pos + 1;
+      if (candidate && pos - (candidate - 1) <= CODEC_WINDOW) {
+        const uint8_t *from = src + candidate - 1;
+        size_t limit = src_size - pos < CODEC_MAX_MATCH ? src_size - pos : CODEC_MAX_MATCH;
+        while (match_length < limit && from[match_length] == src[pos + match_length]) {
+          match_length++;
+        }
+        match_distance = pos - (candidate - 1);
+      }
+    }
+    if (match_length < CODEC_MIN_MATCH) {
+      pos++;
+      continue;
+    }
+    int flushed = put_literals(src, literal_start, pos, dst, out, dst_capacity);
+    if (flushed < 0 || (size_t)flushed + 2 > dst_capacity) {
+      return -1;
+    }
+    out = flushed;
+    dst[out++] = 0x80 | (match_length - CODEC_MIN_MATCH);
+    dst[out++] = match_distance - 1;
+    // Index the copied bytes too, so later repeats can refer into them
+    for (size_t i = 1; i < match_length && pos + i + CODEC_MIN_MATCH <= src_size; i++) {
+      head[hash3(src + pos + i)] = pos + i + 1;
+    }
+    pos += match_length;
+    literal_start = pos;
+  }
+  return put_literals(src, literal_start, src_size, dst, out, dst_capacity);
+}
+
+int codec_decompress(const void *src_bytes, size_t src_size, void *dst_bytes, size_t dst_capacity) {
+  const uint8_t *src = src_bytes;
+  uint8_t *dst = dst_bytes;
+  size_t in = 0;
+  size_t out = 0;
+  while (in < src_size) {
+    uint8_t token = src[in++];
+    if (token < 0x80) {
+      size_t run = token + 1;
+      if (in + run > src_size || out + run > dst_capacity) {
+        return -1;
+      }
+      memcpy(dst + out, src + in, run);
+      in += run;
+      out += run;
+    } else {
+      size_t length = (token & 0x7F) + CODEC_MIN_MATCH;
+      if (in >= src_size) {
+        return -1;
+      }
+      size_t distance = src[in++] + 1;
+      if (distance > out || out + length > dst_capacity) {
+        return -1;
+      }
+      // Byte by byte: a copy may overlap the bytes it produces
+      for (size_t i = 0; i < length; i++, out++) {
+        dst[out] = dst[out - distance];
+      }
+    }
+  }
+  return out;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Byte-oriented LZ77 for persisted records: a token byte below 0x80 is a run
+// of token + 1 literal bytes; 0x80 and up is a copy of (token & 0x7F) +
+// CODEC_MIN_MATCH bytes from one byte of (distance - 1) back, so the window
+// is CODEC_WINDOW bytes and a run of one repeated byte is a copy from 1 back.
+//
+// Allocation-free and reentrant (the match table lives on the stack), and
+// shared as-is by the watch app and the host tools. Time is bounded by the
+// input: compression tries one candidate per input byte, comparing at most
+// CODEC_MAX_MATCH bytes, and decompression touches each output byte once.
+#define CODEC_MIN_MATCH 3
+#define CODEC_MAX_MATCH (0x7F + CODEC_MIN_MATCH)
+#define CODEC_MAX_LITERALS 0x80
+#define CODEC_WINDOW 256
+// Output never exceeds this for incompressible input
+#define CODEC_MAX_PACKED_SIZE(size) ((size) + ((size) + CODEC_MAX_LITERALS - 1) / CODEC_MAX_LITERALS)
+
+// Gather byte i of every stride-byte element into plane i (and back). Run
+// before packing arrays of small structs or integers: fields that rarely
+// change, like the high bytes of small values, become runs the LZ stage
+// packs. Bytes past the last whole element are copied unchanged.
+void codec_split_planes(const void *src, void *dst, size_t size, size_t stride);
+void codec_merge_planes(const void *src, void *dst, size_t size, size_t stride);
+
+// Returns the packed size, or -1 if it would not fit in dst_capacity
+int codec_compress(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+// Returns the unpacked size, or -1 if src is malformed or the output would
+// not fit in dst_capacity
+int codec_decompress(const void *src, size_t src_size, void *dst, size_t dst_capacity);
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Decode a flight recorder dump from the app log.
+
+Opening the flight screen (DOWN on the stats screen) logs the last persisted
+recording between FLIGHT-BEGIN and FLIGHT-END lines. The begin line carries
+the header fields:
+
+    FLIGHT-BEGIN <reason> <frames> <hitch ms> <hitch age> <unix time> <crashed>
+
+followed by hex-encoded 8-byte records, oldest first:
+
+    0  uint8    update ms (simulation ticks run that frame, saturated)
+    1  uint8    draw ms (the previous draw, saturated)
+    2  uint8    active beans
+    3  uint8    bits 0-2 active angels, 3-5 watchdog shed level, 6 swarm
+    4  uint16   heap bytes free / 4
+    6  uint8    stage (background index)
+    7  uint8    input bits (INPUTS below)
+
+Usage: tools/decode_flight_recorder.py app.log          (table and summary)
+       tools/decode_flight_recorder.py --csv app.log > flight.csv
+
+Only the last dump in the log is decoded.
+"""
+import argparse
+import re
+import struct
+import sys
+import time
+
+# Keep in step with FlightReason and the FLIGHT_INPUT_* bits in src/c/birdbeansgame.c
+REASONS = ['none', 'hitch', 'shed']
+INPUTS = ['up', 'select', 'down', 'hold', 'tongue', 'stepping', 'dead']
+RECORD = struct.Struct('<BBBBHBB')
+BEGIN_LINE = re.compile(r'FLIGHT-BEGIN ((?:\d+ ?){6})\s*$')
+RECORD_LINE = re.compile(r'FLIGHT ([0-9a-f]+)\s*$')
+
+
+def last_dump(lines):
+    header = None
+    dump = None
+    last = (None, b'')
+    for line in lines:
+        begin = BEGIN_LINE.search(line)
+        if begin:
+            header = [int(field) for field in begin.group(1).split()]
+            dump = bytearray()
+        elif 'FLIGHT-END' in line:
+            if dump is not None:
+                last = (header, bytes(dump))
+            dump = None
+        elif dump is not None:
+            match = RECORD_LINE.search(line)
+            if match:
+                dump += bytes.fromhex(match.group(1))
+    return last
+
+
+def decode(data):
+    frames = []
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        update_ms, draw_ms, beans, bits, heap_free_4, stage, inputs = \
+            RECORD.unpack_from(data, offset)
+        frames.append({
+            'update_ms': update_ms,
+            'draw_ms': draw_ms,
+            'beans': beans,
+            'angels': bits & 7,
+            'shed': (bits >> 3) & 7,
+            'swarm': (bits >> 6) & 1,
+            'heap_free': heap_free_4 * 4,
+            'stage': stage,
+            'input': '+'.join(name for i, name in enumerate(INPUTS) if inputs & (1 << i)),
+        })
+    return frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('log', nargs='?', help='log file (default: stdin)')
+    parser.add_argument('--csv', action='store_true', help='print CSV instead of a table')
+    args = parser.parse_args()
+
+    stream = open(args.log) if args.log else sys.stdin
+    with stream:
+        header, data = last_dump(stream)
+    if header is None:
+        sys.exit('no FLIGHT-BEGIN/FLIGHT-END dump found')
+    reason, count, hitch_ms, hitch_age, timestamp, crashed = header
+    frames = decode(data)
+    if len(frames) != count:
+        print('warning: header says %d frames, dump has %d' % (count, len(frames)),
+              file=sys.stderr)
+
+    columns = ['frame', 'update_ms', 'draw_ms', 'beans', 'angels', 'shed', 'swarm',
+               'heap_free', 'stage', 'input']
+    if args.csv:
+        print(','.join(columns))
+        for i, frame in enumerate(frames):
+            print(','.join(str(i if c == 'frame' else frame[c]) for c in columns))
+        return
+
+    print('reason %s, %d frames, persisted %s' % (
+        REASONS[reason] if reason < len(REASONS) else reason, count,
+        time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(timestamp))))
+    hitch_index = None
+    if reason == REASONS.index('hitch'):
+        hitch_index = len(frames) - 1 - hitch_age
+        print('hitch of %d ms at frame %d' % (hitch_ms, hitch_index))
+    if crashed:
+        print('the session before the dump did not exit cleanly')
+    if frames:
+        costs = [f['update_ms'] + f['draw_ms'] for f in frames]
+        print('frame cost avg %.1f ms, max %d ms; heap free min %d B' % (
+            sum(costs) / len(costs), max(costs), min(f['heap_free'] for f in frames)))
+    print()
+    print(' '.join('%9s' % c for c in columns))
+    for i, frame in enumerate(frames):
+        row = ' '.join('%9s' % (i if c == 'frame' else frame[c]) for c in columns)
+        print(row + ('  <- hitch' if i == hitch_index else ''))
+
+
+if __name__ == '__main__':
+    main()
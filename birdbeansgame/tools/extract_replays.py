@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Write the replays dumped in an app log out as replay files.
+
+At every game over the app logs the run's replay between REPLAY-BEGIN and
+REPLAY-END lines, hex-encoded in exactly the file layout (little endian):
+
+    0   'P' 'R'     magic
+    2   uint8       version (2; version 1 has no repeat runs)
+    3   uint8       flags: 1 swarm mode, 2 truncated (ran out of event slots),
+                    4 wave mode
+    4   uint32      seed
+    8   uint32      ticks survived
+    12  int32       score
+    16  uint16      event count
+    18  uint16      checkpoint count
+    20  uint16      checkpoint interval in ticks
+    22  uint16      reserved
+    24  uint16[]    events: ticks since the previous event << 3 | input
+                    (0 none, 1 up, 2 up repeat, 3 down, 4 down repeat, 5 select),
+                    or a repeat run (input 6): bits 3-5 how many more repeats
+                    of the previous event's input (1-5), then each one's
+                    ticks since the one before minus 2, two bits each
+        uint32[]    state hash at the start of every interval-th tick
+
+The files are named <seed>_<score>.pyr. tools/host/replay_export.c renders
+them to video.
+
+Usage: tools/extract_replays.py app.log out_dir
+"""
+import os
+import re
+import struct
+import sys
+
+HEADER = struct.Struct('<2sBBIIiHHHH')
+REPLAY_LINE = re.compile(r'REPLAY ([0-9a-f]+)\s*$')
+
+
+def dumps(lines):
+    dump = None
+    for line in lines:
+        if 'REPLAY-BEGIN' in line:
+            dump = bytearray()
+        elif 'REPLAY-END' in line:
+            if dump is not None:
+                yield bytes(dump)
+            dump = None
+        elif dump is not None:
+            match = REPLAY_LINE.search(line)
+            if match:
+                dump += bytes.fromhex(match.group(1))
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    log_path, out_dir = sys.argv[1:]
+    os.makedirs(out_dir, exist_ok=True)
+    written = 0
+    with open(log_path) as log:
+        for data in dumps(log):
+            if len(data) < HEADER.size:
+                print('skipping a short dump', file=sys.stderr)
+                continue
+            magic, version, flags, seed, ticks, score, events, checkpoints, interval, _ = \
+                HEADER.unpack_from(data)
+            if magic != b'PR' or len(data) != HEADER.size + events * 2 + checkpoints * 4:
+                print('skipping a damaged dump (seed %d)' % seed, file=sys.stderr)
+                continue
+            path = os.path.join(out_dir, '%d_%d.pyr' % (seed, score))
+            with open(path, 'wb') as out:
+                out.write(data)
+            written += 1
+            print('%s: %d ticks, %d events, %d checkpoints%s' % (
+                path, ticks, events, checkpoints, ' (truncated)' if flags & 2 else ''))
+    print('%d replays' % written)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+// Gameplay allocation check: loads the window, draws the menu, then plays
+// every replay in a directory through the game, rendering every tick and the
+// game over screen with the real game_layer_update_callback. It counts the
+// heap, bitmap and layer allocations the app asks the SDK for after the
+// window has loaded: on the menu, and from reset_game until the run is over.
+// Everything is reserved at window load, so any allocation after it is a
+// regression: on the watch it can fragment the heap or fail mid-run.
+//
+// Build, from the project root (see replay_export.c for the resources):
+//   cc -O2 -Itools/host -Ibuild/host -o build/host/alloc_check
+//      tools/host/alloc_check.c tools/host/pebble_host.c src/c/codec.c
+// Usage:
+//   build/host/alloc_check [-r resource_dir] replay_dir
+// Exits 1 if the menu or any run allocated, or any replay could not be read.
+#define main pyoro_app_main
+#include "../../src/c/birdbeansgame.c"
+#undef main
+#include "replay_player.h"
+
+#include <dirent.h>
+#include <unistd.h>
+
+static uint8_t *read_replay(const char *path, size_t *size) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint8_t *data = malloc(length > 0 ? length : 1);
+  *size = fread(data, 1, length, file);
+  fclose(file);
+  return data;
+}
+
+// Report and count a span that allocated
+static int check_span(const char *what, HostAllocations before, uint32_t ticks) {
+  HostAllocations after = host_allocations();
+  uint32_t heap = after.heap - before.heap;
+  uint32_t bitmaps = after.bitmaps - before.bitmaps;
+  uint32_t layers = after.layers - before.layers;
+  if (!heap && !bitmaps && !layers) {
+    return 0;
+  }
+  printf("%s: %u heap, %u bitmap and %u layer allocations in %u ticks\n", what, (unsigned)heap,
+         (unsigned)bitmaps, (unsigned)layers, (unsigned)ticks);
+  return 1;
+}
+
+static int compare_names(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: alloc_check [-r resource_dir] replay_dir\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *resource_dir = "build/host";
+  int opt;
+  while ((opt = getopt(argc, argv, "r:")) != -1) {
+    switch (opt) {
+      case 'r': resource_dir = optarg; break;
+      default: usage();
+    }
+  }
+  if (optind != argc - 1) {
+    usage();
+  }
+  DIR *dir = opendir(argv[optind]);
+  if (!dir) {
+    perror(argv[optind]);
+    return 1;
+  }
+  size_t count = 0, capacity = 0;
+  char **names = NULL;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    size_t length = strlen(entry->d_name);
+    if (length < 5 || strcmp(entry->d_name + length - 4, ".pyr") != 0) {
+      continue;
+    }
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      names = realloc(names, capacity * sizeof(char *));
+    }
+    names[count++] = strdup(entry->d_name);
+  }
+  closedir(dir);
+  qsort(names, count, sizeof(char *), compare_names);
+
+  host_init(resource_dir);
+  prv_init();
+  HostAllocations loaded = host_allocations();
+  host_render();
+  int failed = check_span("menu", loaded, 0);
+  uint32_t ticks = 0;
+  for (size_t i = 0; i < count; i++) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", argv[optind], names[i]);
+    size_t size = 0;
+    uint8_t *data = read_replay(path, &size);
+    ReplayPlayer player;
+    if (!data || !replay_player_open(&player, data, size)) {
+      fprintf(stderr, "%s: not a replay file\n", path);
+      failed++;
+      free(data);
+      continue;
+    }
+    HostAllocations before = host_allocations();
+    replay_player_start(&player);
+    host_render();
+    while (replay_player_step(&player)) {
+      host_render();
+    }
+    host_render(); // The game over screen
+    ticks += s_game.ticks;
+    failed += check_span(names[i], before, s_game.ticks);
+    free(data);
+  }
+  printf("%zu replays, %u ticks: %d allocated or unreadable\n", count, (unsigned)ticks, failed);
+  return failed ? 1 : 0;
+}
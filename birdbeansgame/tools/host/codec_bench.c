@@ -0,0 +1,262 @@
+// Persistence codec benchmark: plays every replay in a directory through the
+// game, so lifetime stats, the leaderboard and the best-run replay are
+// written to (host) persistent storage exactly as on the watch, then reports
+// how well src/c/codec.c packs each kind of record and how long a key takes.
+//
+// Every record is also round-tripped through the codec, and the stats are
+// read back through the game's own loader, so a codec change that breaks
+// storage fails here.
+//
+// Build, from the project root (see replay_export.c for the resources):
+//   cc -O2 -Itools/host -Ibuild/host -o build/host/codec_bench
+//      tools/host/codec_bench.c tools/host/pebble_host.c src/c/codec.c
+// Usage:
+//   build/host/codec_bench [-r resource_dir] replay_dir
+// Exits 1 if any record failed to round-trip.
+#define main pyoro_app_main
+#include "../../src/c/birdbeansgame.c"
+#undef main
+#include "replay_player.h"
+
+#include <dirent.h>
+#include <unistd.h>
+
+#define BENCH_TIMING_REPEATS 200 // Each key is packed and unpacked this often when timed
+
+typedef enum {
+  RECORD_STATS,
+  RECORD_HIGH_SCORE,
+  RECORD_HIGH_SCORE_ORDER,
+  RECORD_REPLAY_HEADER,
+  RECORD_REPLAY_EVENTS,
+  RECORD_REPLAY_CHECKPOINTS,
+  RECORD_WORST_CASE, // Random bytes, for the time bound
+  NUM_RECORD_KINDS,
+} RecordKind;
+
+static const char *const RECORD_NAMES[NUM_RECORD_KINDS] = {
+  "lifetime stats", "leaderboard row", "leaderboard order", "replay header", "replay events", "replay checkpoints",
+  "random bytes",
+};
+
+typedef struct {
+  uint32_t keys;
+  uint64_t raw_bytes;
+  uint64_t stored_bytes; // What persist_write_record stores: packed, or raw if that is smaller
+  uint64_t packed_keys;
+  double compress_ns_max;
+  double decompress_ns_max;
+} RecordTotals;
+
+static RecordTotals s_totals[NUM_RECORD_KINDS];
+static int s_failures;
+
+static double ns_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Pack one key's worth of data the way persist_write_record does, check it
+// unpacks to the same bytes and time both directions
+static void bench_record(RecordKind kind, const void *data, size_t size) {
+  uint8_t packed[PERSIST_DATA_MAX_LENGTH];
+  uint8_t unpacked[PERSIST_DATA_MAX_LENGTH];
+  RecordTotals *totals = &s_totals[kind];
+  double start = ns_now();
+  int packed_size = 0;
+  for (int i = 0; i < BENCH_TIMING_REPEATS; i++) {
+    packed_size = codec_compress(data, size, packed, size - 1);
+  }
+  double compress_ns = (ns_now() - start) / BENCH_TIMING_REPEATS;
+  double decompress_ns = 0;
+  if (packed_size > 0) {
+    start = ns_now();
+    int unpacked_size = 0;
+    for (int i = 0; i < BENCH_TIMING_REPEATS; i++) {
+      unpacked_size = codec_decompress(packed, packed_size, unpacked, size);
+    }
+    decompress_ns = (ns_now() - start) / BENCH_TIMING_REPEATS;
+    if (unpacked_size != (int)size || memcmp(unpacked, data, size) != 0) {
+      printf("%s: key %u did not round-trip\n", RECORD_NAMES[kind], totals->keys);
+      s_failures++;
+    }
+    totals->packed_keys++;
+  }
+  totals->keys++;
+  totals->raw_bytes += size;
+  totals->stored_bytes += packed_size > 0 ? (size_t)packed_size : size;
+  if (compress_ns > totals->compress_ns_max) {
+    totals->compress_ns_max = compress_ns;
+  }
+  if (decompress_ns > totals->decompress_ns_max) {
+    totals->decompress_ns_max = decompress_ns;
+  }
+}
+
+// Split into keys and byte planes the way persist_write_blob does
+static void bench_blob(RecordKind kind, const void *data, size_t size, size_t stride) {
+  const uint8_t *bytes = data;
+  uint8_t planes[PERSIST_DATA_MAX_LENGTH];
+  for (size_t offset = 0; offset < size; offset += PERSIST_DATA_MAX_LENGTH) {
+    size_t n = size - offset < PERSIST_DATA_MAX_LENGTH ? size - offset : PERSIST_DATA_MAX_LENGTH;
+    codec_split_planes(bytes + offset, planes, n, stride);
+    bench_record(kind, planes, n);
+  }
+}
+
+static bool load_file(const char *path, uint8_t **out_data, size_t *out_size) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint8_t *data = malloc(size > 0 ? size : 1);
+  bool read = size > 0 && fread(data, 1, size, file) == (size_t)size;
+  fclose(file);
+  if (!read) {
+    free(data);
+    return false;
+  }
+  *out_data = data;
+  *out_size = size;
+  return true;
+}
+
+// Play a replay to its game over, which persists stats, the leaderboard and
+// (for a new best) the replay through the codec
+static bool play_replay(const char *path) {
+  uint8_t *data;
+  size_t size;
+  ReplayPlayer player;
+  if (!load_file(path, &data, &size) || !replay_player_open(&player, data, size)) {
+    printf("%s: not a replay file\n", path);
+    return false;
+  }
+  replay_player_start(&player);
+  while (replay_player_step(&player)) {
+  }
+  // Stats change after every run, so each snapshot is a real record
+  bench_record(RECORD_STATS, &s_stats, sizeof(s_stats));
+  bench_record(RECORD_REPLAY_HEADER, &player.header, sizeof(player.header));
+  bench_blob(RECORD_REPLAY_EVENTS, player.events, player.header.event_count * 2u, sizeof(uint16_t));
+  bench_blob(RECORD_REPLAY_CHECKPOINTS, player.checkpoints, player.header.checkpoint_count * 4u, 1);
+  free(data);
+  return true;
+}
+
+static void bench_storage_round_trip(void) {
+  LifetimeStats saved = s_stats;
+  load_lifetime_stats();
+  if (memcmp(&saved, &s_stats, sizeof(saved)) != 0) {
+    printf("lifetime stats did not read back through persist_read_record\n");
+    s_failures++;
+  }
+  HighScoreEntry scores[NUM_HIGH_SCORES];
+  memcpy(scores, s_high_scores, sizeof(scores));
+  load_high_scores();
+  if (memcmp(scores, s_high_scores, sizeof(scores)) != 0) {
+    printf("leaderboard did not read back through persist_read_record\n");
+    s_failures++;
+  }
+  ReplayHeader best = s_replay.header;
+  if (s_high_scores[0].score != HIGH_SCORE_EMPTY &&
+      (!replay_load_best() || s_replay.header.score != s_high_scores[0].score)) {
+    printf("best replay did not read back through persist_read_record\n");
+    s_failures++;
+  }
+  s_replay.header = best;
+}
+
+static void print_totals(void) {
+  printf("%-18s %6s %9s %9s %6s %7s %13s %13s\n", "record", "keys", "raw", "stored", "ratio", "packed",
+         "pack ns max", "unpack ns max");
+  for (int kind = 0; kind < NUM_RECORD_KINDS; kind++) {
+    const RecordTotals *totals = &s_totals[kind];
+    if (!totals->keys) {
+      continue;
+    }
+    printf("%-18s %6u %9llu %9llu %5.2fx %6.0f%% %13.0f %13.0f\n", RECORD_NAMES[kind], totals->keys,
+           (unsigned long long)totals->raw_bytes, (unsigned long long)totals->stored_bytes,
+           (double)totals->raw_bytes / totals->stored_bytes, 100.0 * totals->packed_keys / totals->keys,
+           totals->compress_ns_max, totals->decompress_ns_max);
+  }
+}
+
+static int compare_names(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: codec_bench [-r resource_dir] replay_dir\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *resource_dir = "build/host";
+  int opt;
+  while ((opt = getopt(argc, argv, "r:")) != -1) {
+    switch (opt) {
+      case 'r': resource_dir = optarg; break;
+      default: usage();
+    }
+  }
+  if (optind != argc - 1) {
+    usage();
+  }
+  DIR *dir = opendir(argv[optind]);
+  if (!dir) {
+    perror(argv[optind]);
+    return 1;
+  }
+  size_t count = 0, capacity = 0;
+  char **names = NULL;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    size_t length = strlen(entry->d_name);
+    if (length < 5 || strcmp(entry->d_name + length - 4, ".pyr") != 0) {
+      continue;
+    }
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      names = realloc(names, capacity * sizeof(char *));
+    }
+    names[count++] = strdup(entry->d_name);
+  }
+  closedir(dir);
+  qsort(names, count, sizeof(char *), compare_names);
+
+  host_init(resource_dir);
+  prv_init();
+  int played = 0;
+  for (size_t i = 0; i < count; i++) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", argv[optind], names[i]);
+    played += play_replay(path);
+    free(names[i]);
+  }
+  free(names);
+  for (int i = 0; i < NUM_HIGH_SCORES; i++) {
+    bench_record(RECORD_HIGH_SCORE, &s_high_scores[i], sizeof(HighScoreEntry));
+  }
+  bench_record(RECORD_HIGH_SCORE_ORDER, s_high_score_slots, sizeof(s_high_score_slots));
+  bench_storage_round_trip();
+  // Incompressible full keys bound the time per key: every position is tried
+  uint32_t state = 0x12345678;
+  for (int k = 0; k < 16; k++) {
+    uint8_t noise[PERSIST_DATA_MAX_LENGTH];
+    for (size_t i = 0; i < sizeof(noise); i++) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      noise[i] = state;
+    }
+    bench_record(RECORD_WORST_CASE, noise, sizeof(noise));
+  }
+
+  printf("%d replays played\n", played);
+  print_totals();
+  return s_failures ? 1 : 0;
+}
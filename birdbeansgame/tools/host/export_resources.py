@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Export the app's basalt resources for the host build in tools/host.
+
+Writes into the output directory:
+    resource_ids.auto.h   RESOURCE_ID_* numbered as the SDK numbers them
+                          (package.json order, 1-based, this platform only)
+    <id>.raw              raw resources, byte for byte
+    <id>.bitmap           bitmaps (the platform's ~color variant where there
+                          is one) as uint16 width, uint16 height, then
+                          width * height GColor8 pixels (2 bits each of
+                          alpha, red, green, blue), little endian
+
+Usage: tools/host/export_resources.py build/host   (run from the project root;
+       needs Pillow)
+"""
+import json
+import os
+import struct
+import sys
+
+from PIL import Image
+
+PLATFORM = 'basalt'
+# Resource qualifiers that match PLATFORM, as the SDK resolves them
+PLATFORM_TAGS = {'basalt', 'color', 'rect'}
+
+
+def to_gcolor8(r, g, b, a):
+    return ((a + 42) // 85) << 6 | ((r + 42) // 85) << 4 | ((g + 42) // 85) << 2 | ((b + 42) // 85)
+
+
+def resolve_variant(path):
+    """The most specific name~tag~tag.ext next to path whose tags all match
+    PLATFORM (see tools/pack_sprite_variants.py), or path itself."""
+    directory, name = os.path.split(path)
+    base, ext = os.path.splitext(name)
+    best, best_tags = path, 0
+    for candidate in os.listdir(directory or '.'):
+        stem, candidate_ext = os.path.splitext(candidate)
+        tags = stem.split('~')
+        if candidate_ext != ext or tags[0] != base or len(tags) == 1:
+            continue
+        if set(tags[1:]) <= PLATFORM_TAGS and len(tags) - 1 > best_tags:
+            best, best_tags = os.path.join(directory, candidate), len(tags) - 1
+    return best
+
+
+def export_bitmap(source, target):
+    image = Image.open(source).convert('RGBA')
+    data = image.tobytes()
+    pixels = bytes(to_gcolor8(*data[i:i + 4]) for i in range(0, len(data), 4))
+    with open(target, 'wb') as out:
+        out.write(struct.pack('<HH', image.width, image.height))
+        out.write(pixels)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    out_dir = sys.argv[1]
+    os.makedirs(out_dir, exist_ok=True)
+    with open('package.json') as f:
+        media = json.load(f)['pebble']['resources']['media']
+
+    ids = []
+    for entry in media:
+        platforms = entry.get('targetPlatforms')
+        if platforms is not None and PLATFORM not in platforms:
+            continue
+        resource_id = len(ids) + 1
+        ids.append(entry['name'])
+        source = resolve_variant(os.path.join('resources', entry['file']))
+        if entry['type'] == 'raw':
+            with open(source, 'rb') as f, open(os.path.join(out_dir, '%d.raw' % resource_id), 'wb') as out:
+                out.write(f.read())
+        elif entry['type'] in ('bitmap', 'png'):
+            export_bitmap(source, os.path.join(out_dir, '%d.bitmap' % resource_id))
+        else:
+            sys.exit('unsupported resource type %s for %s' % (entry['type'], entry['name']))
+
+    with open(os.path.join(out_dir, 'resource_ids.auto.h'), 'w') as out:
+        out.write('// Generated by tools/host/export_resources.py for %s\n#pragma once\n\n' % PLATFORM)
+        out.write('typedef enum {\n  RESOURCE_ID_INVALID = 0,\n')
+        for resource_id, name in enumerate(ids, 1):
+            out.write('  RESOURCE_ID_%s = %d,\n' % (name, resource_id))
+        out.write('} ResourceId;\n')
+    print('%d resources -> %s' % (len(ids), out_dir))
+
+
+if __name__ == '__main__':
+    main()
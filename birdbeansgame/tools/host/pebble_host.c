@@ -0,0 +1,741 @@
+// Host implementation of tools/host/pebble.h: a GColor8 software framebuffer
+// with the drawing calls, layers and text layers the game uses, resources read
+// from the export_resources.py directory and in-memory persistent storage.
+// Text is drawn in a built-in 3x5 pixel font scaled to the requested size,
+// which keeps the layout readable without the watch's font files.
+#define PEBBLE_HOST_SHIM // Allocate with libc here, uncounted
+#include <pebble.h>
+
+#include <stdarg.h>
+
+#define HOST_MAX_CHILDREN 8
+#define HOST_MAX_PERSIST_KEYS 512
+#define HOST_MAX_RESOURCES 256
+
+struct GBitmap {
+  GSize size;
+  uint16_t row_bytes;
+  uint8_t *data;
+  bool owns_data;
+};
+
+struct GContext {
+  GColor fill_color;
+  GColor stroke_color;
+  GColor text_color;
+  GCompOp compositing_mode;
+  GRect frame; // Screen rect of the layer being drawn; drawing is relative and clipped to it
+};
+
+struct HostFont {
+  int scale; // Pixels per font dot
+};
+
+struct Layer {
+  GRect frame;
+  LayerUpdateProc update_proc;
+  Layer *children[HOST_MAX_CHILDREN];
+  int num_children;
+  bool hidden;
+  TextLayer *text_layer;
+};
+
+struct TextLayer {
+  Layer *layer;
+  const char *text;
+  GColor text_color;
+  GColor background_color;
+  GTextAlignment alignment;
+  GFont font;
+};
+
+struct Window {
+  Layer *root;
+  WindowHandlers handlers;
+};
+
+struct HostResource {
+  uint8_t *data;
+  size_t size;
+  bool is_bitmap;
+};
+
+static uint8_t s_framebuffer_pixels[HOST_SCREEN_WIDTH * HOST_SCREEN_HEIGHT];
+static GBitmap s_framebuffer = {
+  .size = {HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT},
+  .row_bytes = HOST_SCREEN_WIDTH,
+  .data = s_framebuffer_pixels,
+};
+static const char *s_resource_dir = ".";
+static struct HostResource s_resources[HOST_MAX_RESOURCES];
+static AppLogLevel s_log_level = APP_LOG_LEVEL_WARNING;
+static struct {
+  uint32_t key;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} s_persist[HOST_MAX_PERSIST_KEYS];
+static int s_persist_count;
+static HostAllocations s_allocations;
+
+// 3x5 glyphs, one octal digit per row, left column in the high bit.
+// Lower case draws as upper case; anything missing draws as a space.
+static const uint16_t s_glyphs[] = {
+  ['!' - ' '] = 022202, ['#' - ' '] = 057575, ['%' - ' '] = 051245, ['\'' - ' '] = 022000,
+  ['(' - ' '] = 024442, [')' - ' '] = 021112, ['+' - ' '] = 002720, [',' - ' '] = 000024,
+  ['-' - ' '] = 000700, ['.' - ' '] = 000002, ['/' - ' '] = 011244, ['0' - ' '] = 075557,
+  ['1' - ' '] = 026227, ['2' - ' '] = 071747, ['3' - ' '] = 071717, ['4' - ' '] = 055711,
+  ['5' - ' '] = 074717, ['6' - ' '] = 074757, ['7' - ' '] = 071111, ['8' - ' '] = 075757,
+  ['9' - ' '] = 075717, [':' - ' '] = 002020, ['<' - ' '] = 012421, ['=' - ' '] = 007070,
+  ['>' - ' '] = 042124, ['?' - ' '] = 071202, ['A' - ' '] = 025755, ['B' - ' '] = 065656,
+  ['C' - ' '] = 034443, ['D' - ' '] = 065556, ['E' - ' '] = 074647, ['F' - ' '] = 074644,
+  ['G' - ' '] = 034553, ['H' - ' '] = 055755, ['I' - ' '] = 072227, ['J' - ' '] = 011152,
+  ['K' - ' '] = 055655, ['L' - ' '] = 044447, ['M' - ' '] = 057755, ['N' - ' '] = 065555,
+  ['O' - ' '] = 025552, ['P' - ' '] = 065644, ['Q' - ' '] = 025563, ['R' - ' '] = 065655,
+  ['S' - ' '] = 034216, ['T' - ' '] = 072222, ['U' - ' '] = 055557, ['V' - ' '] = 055552,
+  ['W' - ' '] = 055775, ['X' - ' '] = 055255, ['Y' - ' '] = 055222, ['Z' - ' '] = 071247,
+};
+
+static const struct HostFont s_font_small = {1};
+static const struct HostFont s_font_medium = {2};
+static const struct HostFont s_font_large = {3};
+
+void host_init(const char *resource_dir) {
+  s_resource_dir = resource_dir;
+}
+
+HostAllocations host_allocations(void) {
+  return s_allocations;
+}
+
+void *host_malloc(size_t size) {
+  s_allocations.heap++;
+  return malloc(size);
+}
+
+void *host_calloc(size_t count, size_t size) {
+  s_allocations.heap++;
+  return calloc(count, size);
+}
+
+void *host_realloc(void *ptr, size_t size) {
+  s_allocations.heap++;
+  return realloc(ptr, size);
+}
+
+void host_set_log_level(AppLogLevel max_level) {
+  s_log_level = max_level;
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  if (log_level > s_log_level) {
+    return;
+  }
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "%s:%d: ", src_filename, src_line_number);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+bool grect_equal(const GRect *a, const GRect *b) {
+  return a->origin.x == b->origin.x && a->origin.y == b->origin.y &&
+         a->size.w == b->size.w && a->size.h == b->size.h;
+}
+
+// Drawing. Every primitive ends in put_pixel, which clips to the layer.
+
+static uint8_t blend(uint8_t dst, uint8_t src) {
+  int alpha = src >> 6;
+  if (alpha == 3) {
+    return src;
+  }
+  if (alpha == 0) {
+    return dst;
+  }
+  uint8_t out = 0xC0;
+  for (int shift = 0; shift < 6; shift += 2) {
+    int s = (src >> shift) & 3;
+    int d = (dst >> shift) & 3;
+    out |= ((s * alpha + d * (3 - alpha) + 1) / 3) << shift;
+  }
+  return out;
+}
+
+static void put_pixel(GContext *ctx, int x, int y, uint8_t argb, bool use_alpha) {
+  if (x < 0 || y < 0 || x >= ctx->frame.size.w || y >= ctx->frame.size.h) {
+    return;
+  }
+  x += ctx->frame.origin.x;
+  y += ctx->frame.origin.y;
+  if (x < 0 || y < 0 || x >= HOST_SCREEN_WIDTH || y >= HOST_SCREEN_HEIGHT) {
+    return;
+  }
+  uint8_t *pixel = &s_framebuffer_pixels[y * HOST_SCREEN_WIDTH + x];
+  *pixel = use_alpha ? blend(*pixel, argb) : (argb | 0xC0);
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  ctx->fill_color = color;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  ctx->stroke_color = color;
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {
+  ctx->text_color = color;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {
+  ctx->compositing_mode = mode;
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+    for (int x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+      put_pixel(ctx, x, y, ctx->fill_color.argb, true);
+    }
+  }
+}
+
+void graphics_draw_rect(GContext *ctx, GRect rect) {
+  int right = rect.origin.x + rect.size.w - 1;
+  int bottom = rect.origin.y + rect.size.h - 1;
+  for (int x = rect.origin.x; x <= right; x++) {
+    put_pixel(ctx, x, rect.origin.y, ctx->stroke_color.argb, true);
+    put_pixel(ctx, x, bottom, ctx->stroke_color.argb, true);
+  }
+  for (int y = rect.origin.y; y <= bottom; y++) {
+    put_pixel(ctx, rect.origin.x, y, ctx->stroke_color.argb, true);
+    put_pixel(ctx, right, y, ctx->stroke_color.argb, true);
+  }
+}
+
+void graphics_draw_pixel(GContext *ctx, GPoint point) {
+  put_pixel(ctx, point.x, point.y, ctx->stroke_color.argb, true);
+}
+
+// Bitmaps tile to fill the rect, as on the watch. GCompOpSet honours alpha;
+// GCompOpAssign copies the pixels as opaque.
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+  if (!bitmap || bitmap->size.w <= 0 || bitmap->size.h <= 0) {
+    return;
+  }
+  bool use_alpha = ctx->compositing_mode == GCompOpSet;
+  for (int y = 0; y < rect.size.h; y++) {
+    const uint8_t *row = bitmap->data + (y % bitmap->size.h) * bitmap->row_bytes;
+    for (int x = 0; x < rect.size.w; x++) {
+      put_pixel(ctx, rect.origin.x + x, rect.origin.y + y, row[x % bitmap->size.w], use_alpha);
+    }
+  }
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+  return &s_framebuffer;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+  return true;
+}
+
+GFont fonts_get_system_font(const char *font_key) {
+  if (strstr(font_key, "24")) {
+    return &s_font_large;
+  }
+  if (strstr(font_key, "18")) {
+    return &s_font_medium;
+  }
+  return &s_font_small;
+}
+
+static void draw_glyph(GContext *ctx, char c, int x, int y, int scale) {
+  if (c >= 'a' && c <= 'z') {
+    c -= 'a' - 'A';
+  }
+  int index = c - ' ';
+  if (index < 0 || index >= (int)(sizeof(s_glyphs) / sizeof(s_glyphs[0]))) {
+    return;
+  }
+  uint16_t glyph = s_glyphs[index];
+  for (int row = 0; row < 5; row++) {
+    for (int col = 0; col < 3; col++) {
+      if (!(glyph & (1 << ((4 - row) * 3 + (2 - col))))) {
+        continue;
+      }
+      for (int dy = 0; dy < scale; dy++) {
+        for (int dx = 0; dx < scale; dx++) {
+          put_pixel(ctx, x + col * scale + dx, y + row * scale + dy, ctx->text_color.argb, true);
+        }
+      }
+    }
+  }
+}
+
+// Greedy word wrap at spaces and newlines, one line per 7 font dots
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box,
+                        GTextOverflowMode overflow_mode, GTextAlignment alignment,
+                        GTextAttributes *text_attributes) {
+  if (!text) {
+    return;
+  }
+  int scale = font ? font->scale : 1;
+  int advance = 4 * scale;
+  int max_chars = box.size.w / advance > 0 ? box.size.w / advance : 1;
+  int y = box.origin.y + scale * 2;
+  const char *line = text;
+  while (*line && y < box.origin.y + box.size.h) {
+    int length = 0;
+    int last_space = -1;
+    while (line[length] && line[length] != '\n' && length < max_chars) {
+      if (line[length] == ' ') {
+        last_space = length;
+      }
+      length++;
+    }
+    int next = length;
+    if (line[length] && line[length] != '\n' && last_space > 0) {
+      length = last_space;
+      next = last_space + 1;
+    } else if (line[length] == '\n') {
+      next = length + 1;
+    }
+    int width = length * advance - scale;
+    int x = box.origin.x;
+    if (alignment == GTextAlignmentCenter) {
+      x += (box.size.w - width) / 2;
+    } else if (alignment == GTextAlignmentRight) {
+      x += box.size.w - width;
+    }
+    for (int i = 0; i < length; i++) {
+      draw_glyph(ctx, line[i], x + i * advance, y, scale);
+    }
+    line += next;
+    y += 7 * scale;
+  }
+}
+
+// Bitmaps
+
+static GBitmap *create_bitmap(GSize size, uint8_t *data) {
+  GBitmap *bitmap = calloc(1, sizeof(GBitmap));
+  bitmap->size = size;
+  bitmap->row_bytes = size.w;
+  bitmap->data = data;
+  bitmap->owns_data = true;
+  return bitmap;
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+  s_allocations.bitmaps++;
+  if (format != GBitmapFormat8Bit) {
+    return NULL; // The color build only asks for 8-bit bitmaps
+  }
+  return create_bitmap(size, calloc(size.w * size.h > 0 ? size.w * size.h : 1, 1));
+}
+
+GBitmap *gbitmap_create_with_resource(uint32_t resource_id) {
+  s_allocations.bitmaps++;
+  ResHandle handle = resource_get_handle(resource_id);
+  if (!handle || !handle->is_bitmap || handle->size < 4) {
+    return NULL;
+  }
+  GSize size = GSize(handle->data[0] | handle->data[1] << 8, handle->data[2] | handle->data[3] << 8);
+  if (handle->size < 4 + (size_t)size.w * size.h) {
+    return NULL;
+  }
+  uint8_t *pixels = malloc(size.w * size.h > 0 ? size.w * size.h : 1);
+  memcpy(pixels, handle->data + 4, size.w * size.h);
+  return create_bitmap(size, pixels);
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+  if (!bitmap || bitmap == &s_framebuffer) {
+    return;
+  }
+  if (bitmap->owns_data) {
+    free(bitmap->data);
+  }
+  free(bitmap);
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+  return GRect(0, 0, bitmap->size.w, bitmap->size.h);
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+  return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+  return bitmap->row_bytes;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+  return GBitmapFormat8Bit;
+}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+  return (GBitmapDataRowInfo) {
+    .data = bitmap->data + y * bitmap->row_bytes,
+    .min_x = 0,
+    .max_x = bitmap->size.w - 1,
+  };
+}
+
+// Layers and windows
+
+static Layer *new_layer(GRect frame) {
+  Layer *layer = calloc(1, sizeof(Layer));
+  layer->frame = frame;
+  return layer;
+}
+
+Layer *layer_create(GRect frame) {
+  s_allocations.layers++;
+  return new_layer(frame);
+}
+
+void layer_destroy(Layer *layer) {
+  free(layer);
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  if (parent->num_children < HOST_MAX_CHILDREN) {
+    parent->children[parent->num_children++] = child;
+  }
+}
+
+void layer_mark_dirty(Layer *layer) {
+  // Every host_render redraws the whole tree
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+  layer->hidden = hidden;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  layer->frame = frame;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+GRect layer_get_unobstructed_bounds(const Layer *layer) {
+  return layer_get_bounds(layer);
+}
+
+static void draw_text_layer(Layer *layer, GContext *ctx) {
+  TextLayer *text_layer = layer->text_layer;
+  graphics_context_set_fill_color(ctx, text_layer->background_color);
+  graphics_fill_rect(ctx, layer_get_bounds(layer), 0, GCornerNone);
+  graphics_context_set_text_color(ctx, text_layer->text_color);
+  graphics_draw_text(ctx, text_layer->text, text_layer->font, layer_get_bounds(layer),
+                     GTextOverflowModeWordWrap, text_layer->alignment, NULL);
+}
+
+TextLayer *text_layer_create(GRect frame) {
+  s_allocations.layers++;
+  TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+  text_layer->layer = new_layer(frame);
+  text_layer->layer->text_layer = text_layer;
+  text_layer->layer->update_proc = draw_text_layer;
+  text_layer->text_color = GColorBlack;
+  text_layer->background_color = GColorWhite;
+  text_layer->font = &s_font_small;
+  return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+  layer_destroy(text_layer->layer);
+  free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+  return text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+  text_layer->text = text;
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+  text_layer->text_color = color;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+  text_layer->background_color = color;
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment alignment) {
+  text_layer->alignment = alignment;
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+  text_layer->font = font;
+}
+
+static Window *s_top_window;
+
+Window *window_create(void) {
+  s_allocations.layers++;
+  Window *window = calloc(1, sizeof(Window));
+  window->root = new_layer(GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+  return window;
+}
+
+void window_destroy(Window *window) {
+  if (window == s_top_window) {
+    if (window->handlers.unload) {
+      window->handlers.unload(window);
+    }
+    s_top_window = NULL;
+  }
+  layer_destroy(window->root);
+  free(window);
+}
+
+Layer *window_get_root_layer(const Window *window) {
+  return window->root;
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+void window_stack_push(Window *window, bool animated) {
+  s_top_window = window;
+  if (window->handlers.load) {
+    window->handlers.load(window);
+  }
+}
+
+static void render_layer(Layer *layer, GRect parent_frame) {
+  if (layer->hidden) {
+    return;
+  }
+  GContext ctx = {
+    .fill_color = GColorBlack,
+    .stroke_color = GColorBlack,
+    .text_color = GColorBlack,
+    .compositing_mode = GCompOpAssign,
+    .frame = GRect(parent_frame.origin.x + layer->frame.origin.x,
+                   parent_frame.origin.y + layer->frame.origin.y,
+                   layer->frame.size.w, layer->frame.size.h),
+  };
+  if (layer->update_proc) {
+    layer->update_proc(layer, &ctx);
+  }
+  for (int i = 0; i < layer->num_children; i++) {
+    render_layer(layer->children[i], ctx.frame);
+  }
+}
+
+const uint8_t *host_render(void) {
+  memset(s_framebuffer_pixels, GColorWhiteARGB8, sizeof(s_framebuffer_pixels));
+  if (s_top_window) {
+    render_layer(s_top_window->root, GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+  }
+  return s_framebuffer_pixels;
+}
+
+void window_set_click_config_provider(Window *window, ClickConfigProvider provider) {
+  if (provider) {
+    provider(NULL);
+  }
+}
+
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler) {
+}
+
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms,
+                                             ClickHandler handler) {
+}
+
+void window_long_click_subscribe(ButtonId button_id, uint16_t delay_ms, ClickHandler down_handler,
+                                 ClickHandler up_handler) {
+}
+
+// Timers and services
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  static char s_timer; // Any non-NULL handle; host timers never fire
+  return (AppTimer *)&s_timer;
+}
+
+void app_timer_cancel(AppTimer *timer) {
+}
+
+void app_event_loop(void) {
+}
+
+void app_focus_service_subscribe_handlers(AppFocusHandlers handlers) {
+}
+
+void app_focus_service_unsubscribe(void) {
+}
+
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void *context) {
+}
+
+void unobstructed_area_service_unsubscribe(void) {
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+}
+
+void battery_state_service_unsubscribe(void) {
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+  return (BatteryChargeState) {.charge_percent = 100, .is_charging = false, .is_plugged = false};
+}
+
+// Resources
+
+static bool read_file(const char *path, struct HostResource *resource) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  resource->data = malloc(size > 0 ? size : 1);
+  resource->size = fread(resource->data, 1, size, file);
+  fclose(file);
+  return true;
+}
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+  if (resource_id == 0 || resource_id >= HOST_MAX_RESOURCES) {
+    return NULL;
+  }
+  struct HostResource *resource = &s_resources[resource_id];
+  if (!resource->data) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%u.raw", s_resource_dir, (unsigned)resource_id);
+    if (!read_file(path, resource)) {
+      snprintf(path, sizeof(path), "%s/%u.bitmap", s_resource_dir, (unsigned)resource_id);
+      if (!read_file(path, resource)) {
+        fprintf(stderr, "missing resource %u in %s\n", (unsigned)resource_id, s_resource_dir);
+        return NULL;
+      }
+      resource->is_bitmap = true;
+    }
+  }
+  return resource;
+}
+
+size_t resource_size(ResHandle handle) {
+  return handle ? handle->size : 0;
+}
+
+size_t resource_load_byte_range(ResHandle handle, uint32_t start_offset, uint8_t *buffer,
+                                size_t num_bytes) {
+  if (!handle || start_offset >= handle->size) {
+    return 0;
+  }
+  if (num_bytes > handle->size - start_offset) {
+    num_bytes = handle->size - start_offset;
+  }
+  memcpy(buffer, handle->data + start_offset, num_bytes);
+  return num_bytes;
+}
+
+size_t resource_load(ResHandle handle, uint8_t *buffer, size_t max_length) {
+  return resource_load_byte_range(handle, 0, buffer, max_length);
+}
+
+// Storage
+
+static int find_key(uint32_t key) {
+  for (int i = 0; i < s_persist_count; i++) {
+    if (s_persist[i].key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool persist_exists(uint32_t key) {
+  return find_key(key) >= 0;
+}
+
+int persist_get_size(uint32_t key) {
+  int i = find_key(key);
+  return i >= 0 ? s_persist[i].size : -1;
+}
+
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size) {
+  int i = find_key(key);
+  if (i < 0) {
+    return -1;
+  }
+  size_t size = s_persist[i].size < buffer_size ? s_persist[i].size : buffer_size;
+  memcpy(buffer, s_persist[i].data, size);
+  return size;
+}
+
+int persist_write_data(uint32_t key, const void *data, size_t size) {
+  if (size > PERSIST_DATA_MAX_LENGTH) {
+    size = PERSIST_DATA_MAX_LENGTH;
+  }
+  int i = find_key(key);
+  if (i < 0) {
+    if (s_persist_count == HOST_MAX_PERSIST_KEYS) {
+      return -1;
+    }
+    i = s_persist_count++;
+    s_persist[i].key = key;
+  }
+  s_persist[i].size = size;
+  memcpy(s_persist[i].data, data, size);
+  return size;
+}
+
+bool persist_read_bool(uint32_t key) {
+  bool value = false;
+  persist_read_data(key, &value, sizeof(value));
+  return value;
+}
+
+int persist_write_bool(uint32_t key, bool value) {
+  return persist_write_data(key, &value, sizeof(value));
+}
+
+int persist_delete(uint32_t key) {
+  int i = find_key(key);
+  if (i >= 0) {
+    s_persist[i] = s_persist[--s_persist_count];
+  }
+  return 0;
+}
+
+// System
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms) {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  uint16_t ms = now.tv_nsec / 1000000;
+  if (t_utc) {
+    *t_utc = now.tv_sec;
+  }
+  if (out_ms) {
+    *out_ms = ms;
+  }
+  return ms;
+}
+
+size_t heap_bytes_free(void) {
+  return 64 * 1024;
+}
+
+size_t heap_bytes_used(void) {
+  return 0;
+}
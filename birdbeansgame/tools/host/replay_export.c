@@ -0,0 +1,367 @@
+// Replay to video: plays a recorded run (see tools/extract_replays.py)
+// through the game's own simulation and renders every tick with the real
+// game_layer_update_callback into the host framebuffer, then writes the
+// frames as a Y4M stream or a numbered PNG sequence.
+//
+// The game keeps its state in statics, so simulating and rendering stay on
+// the main thread; it fills a ring of frame slots that a pool of worker
+// threads converts and compresses in parallel. A Y4M writer thread puts the
+// encoded frames back in order; PNG workers write their files directly.
+//
+// Build, from the project root (needs Pillow for the resource export):
+//   tools/host/export_resources.py build/host
+//   cc -O2 -pthread -Itools/host -Ibuild/host -o build/host/replay_export
+//      tools/host/replay_export.c tools/host/pebble_host.c src/c/codec.c
+// Usage:
+//   build/host/replay_export [-j threads] [-r resource_dir] -y out.y4m run.pyr
+//   build/host/replay_export [-j threads] [-r resource_dir] -p out_dir run.pyr
+// -v prints the game's APP_LOG output, including the replay it records of
+// the run it just played.
+// then e.g. ffmpeg -i out.y4m -vf scale=432:504:flags=neighbor out.mp4
+#define main pyoro_app_main
+#include "../../src/c/birdbeansgame.c"
+#undef main
+#include "replay_player.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define EXPORT_RING_SLOTS 64
+#define EXPORT_GAME_OVER_FRAMES 60 // The game over screen is held this long after the run
+#define EXPORT_PIXELS (HOST_SCREEN_WIDTH * HOST_SCREEN_HEIGHT)
+#define EXPORT_YUV_BYTES (EXPORT_PIXELS * 3 / 2)
+#define PNG_STORED_BLOCK 65535 // Largest uncompressed deflate block
+
+typedef enum {
+  SLOT_FREE,
+  SLOT_RENDERED, // Pixels ready for a worker
+  SLOT_ENCODING,
+  SLOT_ENCODED,  // Y4M only: waiting for the writer
+} SlotState;
+
+typedef struct {
+  uint8_t pixels[EXPORT_PIXELS]; // GColor8
+  uint8_t yuv[EXPORT_YUV_BYTES];
+  uint32_t frame;
+  SlotState state;
+} Slot;
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  Slot slots[EXPORT_RING_SLOTS];
+  bool done;              // No more frames will be rendered
+  uint32_t frames;        // Frames rendered so far
+  uint32_t next_write;    // Y4M: next frame the writer puts out
+  FILE *y4m;
+  const char *png_dir;
+  bool failed;
+} s_export = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .changed = PTHREAD_COND_INITIALIZER,
+};
+
+static uint32_t s_crc_table[256];
+
+static void gcolor_to_rgb(uint8_t argb, uint8_t rgb[3]) {
+  rgb[0] = ((argb >> 4) & 3) * 85;
+  rgb[1] = ((argb >> 2) & 3) * 85;
+  rgb[2] = (argb & 3) * 85;
+}
+
+// Full-range BT.601 4:2:0, chroma averaged over each 2x2 block
+static void encode_yuv(const uint8_t *pixels, uint8_t *yuv) {
+  uint8_t *y_plane = yuv;
+  uint8_t *u_plane = yuv + EXPORT_PIXELS;
+  uint8_t *v_plane = u_plane + EXPORT_PIXELS / 4;
+  for (int i = 0; i < EXPORT_PIXELS; i++) {
+    uint8_t rgb[3];
+    gcolor_to_rgb(pixels[i], rgb);
+    y_plane[i] = (77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2] + 128) >> 8;
+  }
+  for (int y = 0; y < HOST_SCREEN_HEIGHT; y += 2) {
+    for (int x = 0; x < HOST_SCREEN_WIDTH; x += 2) {
+      int r = 0, g = 0, b = 0;
+      for (int n = 0; n < 4; n++) {
+        uint8_t rgb[3];
+        gcolor_to_rgb(pixels[(y + n / 2) * HOST_SCREEN_WIDTH + x + n % 2], rgb);
+        r += rgb[0];
+        g += rgb[1];
+        b += rgb[2];
+      }
+      int i = (y / 2) * (HOST_SCREEN_WIDTH / 2) + x / 2;
+      u_plane[i] = (uint8_t)((-43 * r - 85 * g + 128 * b + 4 * 128 * 256 + 512) >> 10);
+      v_plane[i] = (uint8_t)((128 * r - 107 * g - 21 * b + 4 * 128 * 256 + 512) >> 10);
+    }
+  }
+}
+
+static void crc_init(void) {
+  for (uint32_t n = 0; n < 256; n++) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; k++) {
+      c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    s_crc_table[n] = c;
+  }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    crc = s_crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+static void put_be32(uint8_t *out, uint32_t value) {
+  out[0] = value >> 24;
+  out[1] = value >> 16;
+  out[2] = value >> 8;
+  out[3] = value;
+}
+
+static bool write_chunk(FILE *file, const char *type, const uint8_t *data, uint32_t size) {
+  uint8_t header[8];
+  put_be32(header, size);
+  memcpy(header + 4, type, 4);
+  uint8_t trailer[4];
+  put_be32(trailer, ~crc_update(crc_update(~0u, header + 4, 4), data, size));
+  return fwrite(header, 1, 8, file) == 8 && fwrite(data, 1, size, file) == size &&
+         fwrite(trailer, 1, 4, file) == 4;
+}
+
+// RGB PNG with the image data in stored (uncompressed) deflate blocks: the
+// frames are tiny and this keeps the exporter free of a zlib dependency
+static bool encode_png(const uint8_t *pixels, uint32_t frame) {
+  enum { ROW_BYTES = 1 + HOST_SCREEN_WIDTH * 3, RAW_BYTES = ROW_BYTES * HOST_SCREEN_HEIGHT };
+  enum { BLOCKS = (RAW_BYTES + PNG_STORED_BLOCK - 1) / PNG_STORED_BLOCK };
+  static _Thread_local uint8_t raw[RAW_BYTES];
+  static _Thread_local uint8_t zlib[2 + RAW_BYTES + BLOCKS * 5 + 4];
+  for (int y = 0; y < HOST_SCREEN_HEIGHT; y++) {
+    uint8_t *row = raw + y * ROW_BYTES;
+    row[0] = 0; // Filter: none
+    for (int x = 0; x < HOST_SCREEN_WIDTH; x++) {
+      gcolor_to_rgb(pixels[y * HOST_SCREEN_WIDTH + x], row + 1 + x * 3);
+    }
+  }
+  uint8_t *out = zlib;
+  *out++ = 0x78;
+  *out++ = 0x01;
+  uint32_t a = 1, b = 0;
+  for (size_t offset = 0; offset < RAW_BYTES; offset += PNG_STORED_BLOCK) {
+    uint16_t length = RAW_BYTES - offset < PNG_STORED_BLOCK ? RAW_BYTES - offset : PNG_STORED_BLOCK;
+    *out++ = offset + length == RAW_BYTES; // BFINAL, BTYPE 00
+    *out++ = length & 0xFF;
+    *out++ = length >> 8;
+    *out++ = ~length & 0xFF;
+    *out++ = (uint16_t)~length >> 8;
+    memcpy(out, raw + offset, length);
+    out += length;
+  }
+  for (size_t i = 0; i < RAW_BYTES; i++) {
+    a = (a + raw[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  put_be32(out, b << 16 | a);
+  out += 4;
+
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/frame_%06u.png", s_export.png_dir, frame);
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  uint8_t ihdr[13] = {0};
+  put_be32(ihdr, HOST_SCREEN_WIDTH);
+  put_be32(ihdr + 4, HOST_SCREEN_HEIGHT);
+  ihdr[8] = 8; // Bit depth
+  ihdr[9] = 2; // Truecolor
+  bool ok = fwrite(signature, 1, 8, file) == 8 && write_chunk(file, "IHDR", ihdr, sizeof(ihdr)) &&
+            write_chunk(file, "IDAT", zlib, out - zlib) && write_chunk(file, "IEND", NULL, 0);
+  return fclose(file) == 0 && ok;
+}
+
+static void *encode_worker(void *unused) {
+  pthread_mutex_lock(&s_export.lock);
+  for (;;) {
+    Slot *next = NULL;
+    for (int i = 0; i < EXPORT_RING_SLOTS; i++) {
+      Slot *slot = &s_export.slots[i];
+      if (slot->state == SLOT_RENDERED && (!next || slot->frame < next->frame)) {
+        next = slot;
+      }
+    }
+    if (!next) {
+      if (s_export.done) {
+        break;
+      }
+      pthread_cond_wait(&s_export.changed, &s_export.lock);
+      continue;
+    }
+    next->state = SLOT_ENCODING;
+    pthread_mutex_unlock(&s_export.lock);
+    bool ok = true;
+    if (s_export.y4m) {
+      encode_yuv(next->pixels, next->yuv);
+    } else {
+      ok = encode_png(next->pixels, next->frame);
+    }
+    pthread_mutex_lock(&s_export.lock);
+    s_export.failed |= !ok;
+    next->state = s_export.y4m ? SLOT_ENCODED : SLOT_FREE;
+    pthread_cond_broadcast(&s_export.changed);
+  }
+  pthread_mutex_unlock(&s_export.lock);
+  return NULL;
+}
+
+static void *y4m_writer(void *unused) {
+  pthread_mutex_lock(&s_export.lock);
+  for (;;) {
+    Slot *slot = &s_export.slots[s_export.next_write % EXPORT_RING_SLOTS];
+    if (slot->state == SLOT_ENCODED && slot->frame == s_export.next_write) {
+      pthread_mutex_unlock(&s_export.lock);
+      bool ok = fputs("FRAME\n", s_export.y4m) >= 0 &&
+                fwrite(slot->yuv, 1, EXPORT_YUV_BYTES, s_export.y4m) == EXPORT_YUV_BYTES;
+      pthread_mutex_lock(&s_export.lock);
+      s_export.failed |= !ok;
+      slot->state = SLOT_FREE;
+      s_export.next_write++;
+      pthread_cond_broadcast(&s_export.changed);
+    } else if (s_export.done && s_export.next_write == s_export.frames) {
+      break;
+    } else {
+      pthread_cond_wait(&s_export.changed, &s_export.lock);
+    }
+  }
+  pthread_mutex_unlock(&s_export.lock);
+  return NULL;
+}
+
+// Hand the current framebuffer to the workers, waiting for a free slot
+static void submit_frame(const uint8_t *pixels) {
+  Slot *slot = &s_export.slots[s_export.frames % EXPORT_RING_SLOTS];
+  pthread_mutex_lock(&s_export.lock);
+  while (slot->state != SLOT_FREE) {
+    pthread_cond_wait(&s_export.changed, &s_export.lock);
+  }
+  pthread_mutex_unlock(&s_export.lock);
+  memcpy(slot->pixels, pixels, EXPORT_PIXELS);
+  pthread_mutex_lock(&s_export.lock);
+  slot->frame = s_export.frames++;
+  slot->state = SLOT_RENDERED;
+  pthread_cond_broadcast(&s_export.changed);
+  pthread_mutex_unlock(&s_export.lock);
+}
+
+static uint8_t *read_replay(const char *path, size_t *size) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint8_t *data = malloc(length > 0 ? length : 1);
+  *size = fread(data, 1, length, file);
+  fclose(file);
+  return data;
+}
+
+static double seconds_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: replay_export [-v] [-j threads] [-r resource_dir] (-y out.y4m | -p out_dir) run.pyr\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  const char *resource_dir = "build/host";
+  const char *y4m_path = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "vj:r:y:p:")) != -1) {
+    switch (opt) {
+      case 'v': host_set_log_level(APP_LOG_LEVEL_DEBUG); break;
+      case 'j': threads = atoi(optarg); break;
+      case 'r': resource_dir = optarg; break;
+      case 'y': y4m_path = optarg; break;
+      case 'p': s_export.png_dir = optarg; break;
+      default: usage();
+    }
+  }
+  if (optind != argc - 1 || !y4m_path == !s_export.png_dir) {
+    usage();
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+
+  size_t size = 0;
+  uint8_t *data = read_replay(argv[optind], &size);
+  ReplayPlayer player;
+  if (!data || !replay_player_open(&player, data, size)) {
+    fprintf(stderr, "%s: not a replay file\n", argv[optind]);
+    return 1;
+  }
+  if (y4m_path) {
+    s_export.y4m = fopen(y4m_path, "wb");
+    if (!s_export.y4m) {
+      perror(y4m_path);
+      return 1;
+    }
+    fprintf(s_export.y4m, "YUV4MPEG2 W%d H%d F1000:%d Ip A1:1 C420jpeg\n",
+            HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT, SIM_TICK_MS);
+  }
+
+  host_init(resource_dir);
+  prv_init();
+  crc_init();
+  double start = seconds_now();
+  pthread_t workers[threads];
+  for (int i = 0; i < threads; i++) {
+    pthread_create(&workers[i], NULL, encode_worker, NULL);
+  }
+  pthread_t writer;
+  if (s_export.y4m) {
+    pthread_create(&writer, NULL, y4m_writer, NULL);
+  }
+
+  replay_player_start(&player);
+  submit_frame(host_render());
+  while (replay_player_step(&player)) {
+    submit_frame(host_render());
+  }
+  const uint8_t *game_over = host_render();
+  for (int i = 0; i < EXPORT_GAME_OVER_FRAMES; i++) {
+    submit_frame(game_over);
+  }
+
+  pthread_mutex_lock(&s_export.lock);
+  s_export.done = true;
+  pthread_cond_broadcast(&s_export.changed);
+  pthread_mutex_unlock(&s_export.lock);
+  for (int i = 0; i < threads; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  if (s_export.y4m) {
+    pthread_join(writer, NULL);
+    s_export.failed |= fclose(s_export.y4m) != 0;
+  }
+  double elapsed = seconds_now() - start;
+
+  fprintf(stderr, "%u frames (%u ticks, score %d, recorded %d) in %.2fs, %.0f frames/s, %d threads\n",
+          s_export.frames, (unsigned)s_game.ticks, (int)s_game.score, (int)player.header.score,
+          elapsed, s_export.frames / (elapsed > 0 ? elapsed : 1), threads);
+  if (player.diverged_tick != UINT32_MAX) {
+    fprintf(stderr, "warning: state diverged from the recording at tick %u\n", player.diverged_tick);
+  }
+  prv_deinit();
+  free(data);
+  return s_export.failed ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+// Replay playback for the host tools. Include after src/c/birdbeansgame.c:
+// it drives the game's own statics, click handlers and update_game, exactly
+// as game_update does on the watch, one fixed tick at a time.
+#pragma once
+
+typedef struct {
+  ReplayHeader header;
+  const uint8_t *events;      // header.event_count little-endian uint16_t
+  const uint8_t *checkpoints; // header.checkpoint_count little-endian uint32_t
+  uint32_t next_event;        // Index of the next event to read
+  uint32_t next_event_tick;   // Tick the next input arrives before, or UINT32_MAX
+  uint8_t next_input;         // ReplayInput
+  uint8_t run_left;           // Repeats of next_input still to come from a run event
+  uint16_t run_deltas;        // Their spacing, two bits each, as recorded
+  uint32_t checked;           // Checkpoints compared so far
+  uint32_t diverged_tick;     // First checkpoint tick whose hash differed, or UINT32_MAX
+} ReplayPlayer;
+
+// Validate a replay file in memory; the player points into the buffer
+static bool replay_player_open(ReplayPlayer *player, const uint8_t *data, size_t size) {
+  memset(player, 0, sizeof(*player));
+  if (size < sizeof(ReplayHeader)) {
+    return false;
+  }
+  memcpy(&player->header, data, sizeof(ReplayHeader));
+  const ReplayHeader *header = &player->header;
+  if (header->magic[0] != 'P' || header->magic[1] != 'R' || (header->version != 1 && header->version != REPLAY_VERSION) ||
+      size != sizeof(ReplayHeader) + header->event_count * 2u + header->checkpoint_count * 4u) {
+    return false;
+  }
+  player->events = data + sizeof(ReplayHeader);
+  player->checkpoints = player->events + header->event_count * 2u;
+  player->diverged_tick = UINT32_MAX;
+  return true;
+}
+
+static uint32_t replay_event_at(const ReplayPlayer *player, uint32_t index) {
+  return player->events[index * 2] | player->events[index * 2 + 1] << 8;
+}
+
+static uint32_t replay_checkpoint_at(const ReplayPlayer *player, uint32_t index) {
+  const uint8_t *bytes = player->checkpoints + index * 4;
+  return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// Queue the input after the one at from_tick: the next repeat of an open run,
+// else the next event. Version 1 files never contain runs.
+static void replay_player_advance(ReplayPlayer *player, uint32_t from_tick) {
+  while (!player->run_left) {
+    if (player->next_event >= player->header.event_count) {
+      player->next_event_tick = UINT32_MAX;
+      return;
+    }
+    uint32_t event = replay_event_at(player, player->next_event++);
+    if ((event & REPLAY_EVENT_INPUT_MASK) != REPLAY_INPUT_REPEAT_RUN) {
+      player->next_input = event & REPLAY_EVENT_INPUT_MASK;
+      player->next_event_tick = from_tick + (event >> REPLAY_EVENT_INPUT_BITS);
+      return;
+    }
+    player->run_left = (event >> REPLAY_EVENT_INPUT_BITS) & 7;
+    player->run_deltas = event >> REPLAY_RUN_DELTA_SHIFT;
+  }
+  player->run_left--;
+  player->next_event_tick = from_tick + (player->run_deltas & 3) + REPLAY_RUN_MIN_DELTA;
+  player->run_deltas >>= 2;
+}
+
+// Start the run the way the menu does, then restore the recorded seed and mode
+static void replay_player_start(ReplayPlayer *player) {
+  reset_game();
+  s_game.seed = player->header.seed;
+  game_srand(s_game.seed);
+  s_game.swarm = (player->header.flags & REPLAY_FLAG_SWARM) != 0;
+  if (player->header.flags & REPLAY_FLAG_WAVES) {
+    start_wave_mode();
+  }
+  s_prev_game = s_game;
+  s_interp_alpha = 256;
+  player->next_event = 0;
+  player->run_left = 0;
+  replay_player_advance(player, 0);
+}
+
+static void replay_apply_input(ReplayInput input) {
+  switch (input) {
+    case REPLAY_INPUT_UP: prv_up_click_handler(NULL, NULL); break;
+    case REPLAY_INPUT_UP_REPEAT: prv_up_repeating_click_handler(NULL, NULL); break;
+    case REPLAY_INPUT_DOWN: prv_down_click_handler(NULL, NULL); break;
+    case REPLAY_INPUT_DOWN_REPEAT: prv_down_repeating_click_handler(NULL, NULL); break;
+    case REPLAY_INPUT_SELECT: prv_select_click_handler(NULL, NULL); break;
+    case REPLAY_INPUT_NONE:
+    case REPLAY_INPUT_REPEAT_RUN: break; // Expanded by replay_player_advance
+  }
+}
+
+// Apply this tick's inputs and run one simulation tick, comparing any state
+// hash the game records against the replay's. False once the run is over.
+static bool replay_player_step(ReplayPlayer *player) {
+  if (s_game.state != GAME_STATE_PLAYING) {
+    return false;
+  }
+  while (player->next_event_tick == s_game.ticks && !s_game.pyoro.dead) {
+    replay_apply_input(player->next_input);
+    replay_player_advance(player, s_game.ticks);
+  }
+  uint32_t tick = s_game.ticks;
+  s_prev_game = s_game;
+  update_game(SIM_DT);
+  while (player->checked < s_replay.header.checkpoint_count &&
+         player->checked < player->header.checkpoint_count) {
+    if (s_replay.checkpoints[player->checked] != replay_checkpoint_at(player, player->checked) &&
+        player->diverged_tick == UINT32_MAX) {
+      player->diverged_tick = tick;
+    }
+    player->checked++;
+  }
+  return true;
+}
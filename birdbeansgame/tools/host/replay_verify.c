@@ -0,0 +1,230 @@
+// Replay corpus verifier: re-simulates every replay file in a directory
+// with the current game source and checks each state-hash checkpoint and the
+// final tick count and score against the recording. Run it after every
+// physics change; a replay that no longer matches reports the first
+// checkpoint that diverged.
+//
+// The game keeps its state in statics, so the parallelism is one process
+// per core rather than threads: the parent maps every file read-only and
+// forks the workers, which claim replays from a shared counter and write
+// their results into a shared table.
+//
+// Build, from the project root (see replay_export.c for the resources):
+//   cc -O2 -Itools/host -Ibuild/host -o build/host/replay_verify
+//      tools/host/replay_verify.c tools/host/pebble_host.c src/c/codec.c
+// Usage:
+//   build/host/replay_verify [-j processes] [-r resource_dir] replay_dir
+// Exits 1 if any replay diverged or could not be read.
+#define main pyoro_app_main
+#include "../../src/c/birdbeansgame.c"
+#undef main
+#include "replay_player.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef enum {
+  VERIFY_PENDING,
+  VERIFY_MATCH,
+  VERIFY_DIVERGED,
+  VERIFY_TRUNCATED, // Recorded without all its inputs; a mismatch is expected
+  VERIFY_BAD_FILE,
+} VerifyStatus;
+
+typedef struct {
+  char path[512];
+  const uint8_t *data;
+  size_t size;
+} ReplayFile;
+
+typedef struct {
+  uint8_t status;          // VerifyStatus
+  uint32_t diverged_tick;  // Checkpoint tick whose hash first differed, or UINT32_MAX
+  uint32_t ticks;          // Re-simulated
+  int32_t score;
+} VerifyResult;
+
+static int compare_paths(const void *a, const void *b) {
+  return strcmp(((const ReplayFile *)a)->path, ((const ReplayFile *)b)->path);
+}
+
+static size_t map_replays(const char *dir_path, ReplayFile **out_files) {
+  DIR *dir = opendir(dir_path);
+  if (!dir) {
+    perror(dir_path);
+    exit(1);
+  }
+  size_t count = 0, capacity = 0;
+  ReplayFile *files = NULL;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    size_t length = strlen(entry->d_name);
+    if (length < 5 || strcmp(entry->d_name + length - 4, ".pyr") != 0) {
+      continue;
+    }
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      files = realloc(files, capacity * sizeof(ReplayFile));
+    }
+    ReplayFile *file = &files[count++];
+    memset(file, 0, sizeof(*file));
+    snprintf(file->path, sizeof(file->path), "%s/%s", dir_path, entry->d_name);
+    int fd = open(file->path, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        file->data = data;
+        file->size = st.st_size;
+      }
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  closedir(dir);
+  qsort(files, count, sizeof(ReplayFile), compare_paths);
+  *out_files = files;
+  return count;
+}
+
+static void verify_replay(const ReplayFile *file, VerifyResult *result) {
+  ReplayPlayer player;
+  result->diverged_tick = UINT32_MAX;
+  if (!file->data || !replay_player_open(&player, file->data, file->size)) {
+    result->status = VERIFY_BAD_FILE;
+    return;
+  }
+  replay_player_start(&player);
+  while (replay_player_step(&player)) {
+  }
+  result->ticks = s_game.ticks;
+  result->score = s_game.score;
+  result->diverged_tick = player.diverged_tick;
+  bool matches = player.diverged_tick == UINT32_MAX && player.checked == player.header.checkpoint_count &&
+                 s_game.ticks == player.header.ticks && s_game.score == player.header.score;
+  if (matches) {
+    result->status = VERIFY_MATCH;
+  } else if (player.header.flags & REPLAY_FLAG_TRUNCATED) {
+    result->status = VERIFY_TRUNCATED;
+  } else {
+    result->status = VERIFY_DIVERGED;
+  }
+}
+
+static double seconds_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: replay_verify [-j processes] [-r resource_dir] replay_dir\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  int processes = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  const char *resource_dir = "build/host";
+  int opt;
+  while ((opt = getopt(argc, argv, "j:r:")) != -1) {
+    switch (opt) {
+      case 'j': processes = atoi(optarg); break;
+      case 'r': resource_dir = optarg; break;
+      default: usage();
+    }
+  }
+  if (optind != argc - 1) {
+    usage();
+  }
+
+  double start = seconds_now();
+  ReplayFile *files;
+  size_t count = map_replays(argv[optind], &files);
+  if (processes < 1) {
+    processes = 1;
+  }
+  if ((size_t)processes > count) {
+    processes = count ? count : 1;
+  }
+  // Shared with the workers: the next replay to claim, then one result per file
+  size_t shared_size = sizeof(uint32_t) + count * sizeof(VerifyResult);
+  uint8_t *shared = mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  uint32_t *next_file = (uint32_t *)shared;
+  VerifyResult *results = (VerifyResult *)(shared + sizeof(uint32_t));
+
+  host_init(resource_dir);
+  prv_init();
+  fflush(NULL);
+  for (int p = 0; p < processes; p++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      return 1;
+    }
+    if (pid == 0) {
+      uint32_t index;
+      while ((index = __atomic_fetch_add(next_file, 1, __ATOMIC_RELAXED)) < count) {
+        verify_replay(&files[index], &results[index]);
+      }
+      _exit(0);
+    }
+  }
+  int worker_failures = 0;
+  for (int p = 0; p < processes; p++) {
+    int status;
+    if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      worker_failures++;
+    }
+  }
+  double elapsed = seconds_now() - start;
+
+  int failed = 0, truncated = 0;
+  for (size_t i = 0; i < count; i++) {
+    const VerifyResult *result = &results[i];
+    ReplayPlayer player;
+    replay_player_open(&player, files[i].data, files[i].size);
+    const ReplayHeader *header = &player.header;
+    switch (result->status) {
+      case VERIFY_MATCH:
+        break;
+      case VERIFY_TRUNCATED:
+        truncated++;
+        break;
+      case VERIFY_BAD_FILE:
+        printf("%s: not a replay file\n", files[i].path);
+        failed++;
+        break;
+      case VERIFY_PENDING:
+        printf("%s: not verified (worker crashed)\n", files[i].path);
+        failed++;
+        break;
+      case VERIFY_DIVERGED:
+        failed++;
+        if (result->diverged_tick == 0) {
+          printf("%s: diverged before the first tick\n", files[i].path);
+        } else if (result->diverged_tick != UINT32_MAX) {
+          // Checkpoint hashes are taken at the start of a tick, so the
+          // state went wrong in one of the ticks since the last match
+          uint32_t interval = header->checkpoint_interval ? header->checkpoint_interval : 1;
+          printf("%s: diverged in ticks %u-%u\n", files[i].path,
+                 result->diverged_tick - interval, result->diverged_tick - 1);
+        } else {
+          printf("%s: checkpoints match but the run ended at tick %u score %d, recorded tick %u score %d\n",
+                 files[i].path, result->ticks, (int)result->score, header->ticks, (int)header->score);
+        }
+        break;
+    }
+  }
+  printf("%zu replays: %zu match, %d diverged, %d truncated; %.2fs on %d processes\n", count,
+         count - failed - truncated, failed, truncated, elapsed, processes);
+  return failed || worker_failures ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Pack the stage backgrounds as run-length encoded 8-bit pixels.
+
+On the color platforms the app keeps one fixed 8-bit background bitmap,
+allocated when the window loads, and decodes the next stage into it when the
+stage changes. Nothing is allocated mid-run, unlike creating a bitmap from a
+PNG resource. Each source pixel is reduced to the nearest GColor8 (2 bits per
+channel), the same as the SDK does for 8-bit bitmaps.
+
+File layout (little endian):
+    0  'B' 'R'        magic (shared with pack_background_rows.py)
+    2  uint8          bits per pixel (8)
+    3  uint8          flags, 1 = run-length encoded
+    4  uint16         width in pixels
+    6  uint16         height in rows
+    8  runs           uint8 count (1..255), uint8 GColor8 argb; runs follow
+                      the pixels in row-major order and may cross rows
+
+Usage: tools/pack_background_rle.py   (run from the project root; needs Pillow)
+"""
+import os
+import struct
+import sys
+
+from PIL import Image
+
+NUM_BACKGROUNDS = 21
+SOURCE_DIR = os.path.join('resources', 'background 1')
+OUTPUT_DIR = os.path.join(SOURCE_DIR, 'rle')
+FLAG_RLE = 1
+
+
+def to_gcolor8(r, g, b):
+    return 0xC0 | ((r + 42) // 85) << 4 | ((g + 42) // 85) << 2 | ((b + 42) // 85)
+
+
+def encode_runs(image):
+    source = image.convert('RGB')
+    data = source.tobytes()
+    pixels = [to_gcolor8(*data[i:i + 3]) for i in range(0, len(data), 3)]
+    out = bytearray()
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while run < 255 and i + run < len(pixels) and pixels[i + run] == pixels[i]:
+            run += 1
+        out += bytes((run, pixels[i]))
+        i += run
+    return out
+
+
+def main():
+    os.makedirs(OUTPUT_DIR, exist_ok=True)
+    total = 0
+    for index in range(NUM_BACKGROUNDS):
+        src = os.path.join(SOURCE_DIR, 'background_%d.png' % index)
+        dst = os.path.join(OUTPUT_DIR, 'background_%d.bin' % index)
+        image = Image.open(src)
+        runs = encode_runs(image)
+        with open(dst, 'wb') as f:
+            f.write(b'BR' + struct.pack('<BBHH', 8, FLAG_RLE, image.width, image.height))
+            f.write(runs)
+        total += 8 + len(runs)
+        print('%s -> %s (%d bytes)' % (src, dst, 8 + len(runs)))
+    print('total %d bytes' % total)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
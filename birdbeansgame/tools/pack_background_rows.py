@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Pack the stage backgrounds as raw 1-bit framebuffer rows.
+
+On aplite and diorite the backgrounds are not loaded as bitmaps. The app
+streams just the rows it needs straight from the resource pack with
+resource_load_byte_range(), so this script lays each background out exactly
+as it appears on a 144x168 screen (graphics_draw_bitmap_in_rect() tiles the
+160x144 source image), dithers it to black and white and writes one packed
+row after another.
+
+File layout (little endian):
+    0  'B' 'R'        magic
+    2  uint8          bits per pixel (1)
+    3  uint8          reserved
+    4  uint16         width in pixels
+    6  uint16         height in rows
+    8  rows           ceil(width / 8) bytes each, pixel x in bit (x % 8)
+                      of byte x / 8, 1 = white (GBitmapFormat1Bit order)
+
+Usage: tools/pack_background_rows.py   (run from the project root; needs Pillow)
+"""
+import os
+import struct
+import sys
+
+from PIL import Image
+
+NUM_BACKGROUNDS = 21
+SCREEN_WIDTH = 144
+SCREEN_HEIGHT = 168
+SOURCE_DIR = os.path.join('resources', 'background 1')
+OUTPUT_DIR = os.path.join(SOURCE_DIR, 'rows')
+
+# 4x4 ordered dither thresholds (0..255)
+BAYER_4X4 = [[(v * 16 + 8) for v in row] for row in (
+    (0, 8, 2, 10),
+    (12, 4, 14, 6),
+    (3, 11, 1, 9),
+    (15, 7, 13, 5),
+)]
+
+
+def pack_rows(image, width, height):
+    source = image.convert('L')
+    src_w, src_h = source.size
+    pixels = source.load()
+    row_bytes = (width + 7) // 8
+    out = bytearray()
+    for y in range(height):
+        row = bytearray(row_bytes)
+        for x in range(width):
+            # Square the luminance so dark skies stay mostly black on the
+            # memory LCD instead of turning into a busy 50% dot pattern
+            luminance = pixels[x % src_w, y % src_h] ** 2 // 255
+            if luminance > BAYER_4X4[y % 4][x % 4]:
+                row[x // 8] |= 1 << (x % 8)
+        out += row
+    return out
+
+
+def main():
+    os.makedirs(OUTPUT_DIR, exist_ok=True)
+    for index in range(NUM_BACKGROUNDS):
+        src = os.path.join(SOURCE_DIR, 'background_%d.png' % index)
+        dst = os.path.join(OUTPUT_DIR, 'background_%d.bin' % index)
+        rows = pack_rows(Image.open(src), SCREEN_WIDTH, SCREEN_HEIGHT)
+        with open(dst, 'wb') as f:
+            f.write(b'BR' + struct.pack('<BBHH', 1, 0, SCREEN_WIDTH, SCREEN_HEIGHT))
+            f.write(rows)
+        print('%s -> %s (%d bytes)' % (src, dst, 8 + len(rows)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Generate the per-platform variants of every bitmap resource.
+
+package.json names one file per bitmap (e.g. images/angel.png, the RGBA
+source art). The SDK resolves that name against files carrying resource
+qualifiers and installs only the best match on each platform, so for every
+bitmap this script writes alongside its source:
+
+    name~bw.png           aplite, diorite: dithered to black and white with
+                          1-bit transparency, a 3-entry palette
+    name~color.png        basalt: reduced to GColor8 (2 bits per channel and
+                          alpha), palettized so the SDK picks the smallest
+                          palette format instead of 8-bit
+    name~color~round.png  chalk: as ~color, scaled to chalk's game grid
+    name~color~emery.png  emery: as ~color, scaled to emery's game grid
+
+The round and emery files carry ~color as well so they are strictly more
+specific than ~color on those platforms rather than tied with it. Sprites
+are drawn at their own size, centered on their grid position, and the grid
+grows with the screen (game area = screen minus the 20-pixel score strip,
+20x20 cells), so scaled variants keep them in proportion; nearest-neighbour
+scaling keeps the pixel art crisp. The menu icon keeps its size everywhere.
+
+Usage: tools/pack_sprite_variants.py   (run from the project root; needs Pillow)
+"""
+import json
+import os
+import sys
+
+from PIL import Image
+
+SCORE_STRIP = 20
+BASE_SCREEN = (144, 168)
+
+# Qualifier suffix -> (display, screen size or None for unscaled)
+VARIANTS = (
+    ('~bw', 'bw', None),
+    ('~color', 'color', None),
+    ('~color~round', 'color', (180, 180)),
+    ('~color~emery', 'color', (200, 228)),
+)
+
+# 4x4 ordered dither thresholds (0..255), as in pack_background_rows.py
+BAYER_4X4 = [[(v * 16 + 8) for v in row] for row in (
+    (0, 8, 2, 10),
+    (12, 4, 14, 6),
+    (3, 11, 1, 9),
+    (15, 7, 13, 5),
+)]
+
+
+def grid_scale(screen):
+    """Ratio of a screen's game cells to the 144x168 ones, the smaller axis."""
+    base_w, base_h = BASE_SCREEN
+    width, height = screen
+    return min(width / base_w, (height - SCORE_STRIP) / (base_h - SCORE_STRIP))
+
+
+def scaled(image, screen):
+    if screen is None:
+        return image
+    factor = grid_scale(screen)
+    size = (max(1, round(image.width * factor)), max(1, round(image.height * factor)))
+    return image.resize(size, Image.NEAREST)
+
+
+def to_bw(image):
+    """Black, white and transparent, ordered-dithered on luminance."""
+    rgba = image.convert('RGBA')
+    luminance = rgba.convert('L').load()
+    alpha = rgba.getchannel('A').load()
+    out = Image.new('P', rgba.size, 2)
+    out.putpalette([0, 0, 0, 255, 255, 255, 0, 0, 0])
+    pixels = out.load()
+    for y in range(rgba.height):
+        for x in range(rgba.width):
+            if alpha[x, y] >= 128:
+                # Lift mid-tones: the backgrounds are dithered dark
+                # (pack_background_rows.py), so sprites lean light to stand out
+                lifted = int((luminance[x, y] / 255) ** 0.5 * 255)
+                pixels[x, y] = 1 if lifted > BAYER_4X4[y % 4][x % 4] else 0
+    return out, bytes([255, 255, 0])
+
+
+def quantize_channel(value):
+    return (value + 42) // 85 * 85
+
+
+def to_color(image):
+    """Every pixel reduced to GColor8, as one palette entry per distinct color."""
+    rgba = image.convert('RGBA')
+    source = rgba.load()
+    colors = {}
+    out = Image.new('P', rgba.size, 0)
+    pixels = out.load()
+    for y in range(rgba.height):
+        for x in range(rgba.width):
+            r, g, b, a = (quantize_channel(c) for c in source[x, y])
+            if a == 0:
+                r = g = b = 0  # All fully transparent pixels share one entry
+            pixels[x, y] = colors.setdefault((r, g, b, a), len(colors))
+    if len(colors) > 256:
+        raise ValueError('more than 256 GColor8 colors')
+    palette = sorted(colors, key=colors.get)
+    out.putpalette([channel for color in palette for channel in color[:3]])
+    return out, bytes(color[3] for color in palette)
+
+
+def write_variants(source, menu_icon):
+    image = Image.open(source)
+    base, ext = os.path.splitext(source)
+    written = []
+    for suffix, display, screen in VARIANTS:
+        variant = scaled(image, None if menu_icon else screen)
+        out, alpha = to_bw(variant) if display == 'bw' else to_color(variant)
+        path = base + suffix + ext
+        out.save(path, transparency=alpha, optimize=True)
+        written.append((path, out.size, len(alpha)))
+    return written
+
+
+def main():
+    with open('package.json') as f:
+        media = json.load(f)['pebble']['resources']['media']
+    count = 0
+    for entry in media:
+        if entry['type'] not in ('bitmap', 'png'):
+            continue
+        source = os.path.join('resources', entry['file'])
+        for path, size, colors in write_variants(source, entry.get('menuIcon', False)):
+            print('%s: %dx%d, %d colors' % (path, size[0], size[1], colors))
+            count += 1
+    print('%d variants' % count)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
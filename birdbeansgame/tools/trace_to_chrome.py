@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Convert a trace dump from the app log into Chrome/Perfetto trace JSON.
+
+Build the app with -DTRACE. At the end of every run it logs its trace ring
+between TRACE-BEGIN and TRACE-END lines, as hex-encoded 8-byte records:
+
+    0  uint32   milliseconds since the run started
+    4  uint8    phase: 0 begin, 1 end, 2 instant
+    5  uint8    event (EVENTS below, same order as TraceEvent in the app)
+    6  uint16   argument (bean slot, points, score)
+
+Usage: tools/trace_to_chrome.py app.log > trace.json
+       (open trace.json in chrome://tracing or ui.perfetto.dev)
+
+Only the last dump in the log is converted. The log can come from
+`pebble logs` or from anything else that prints the same lines.
+"""
+import json
+import re
+import struct
+import sys
+
+# Keep in step with TraceEvent in src/c/birdbeansgame.c
+EVENTS = [
+    'update', 'input', 'tongue', 'beans', 'angels', 'spawn', 'stage',
+    'draw', 'draw scene', 'draw sprites', 'draw overlay',
+    'bean spawned', 'bean caught', 'pyoro died',
+]
+PHASES = ['B', 'E', 'i']
+RECORD = struct.Struct('<IBBH')
+TRACE_LINE = re.compile(r'TRACE ([0-9a-f]+)\s*$')
+
+
+def last_dump(lines):
+    dump = None
+    last = b''
+    for line in lines:
+        if 'TRACE-BEGIN' in line:
+            dump = bytearray()
+        elif 'TRACE-END' in line:
+            if dump is not None:
+                last = bytes(dump)
+            dump = None
+        elif dump is not None:
+            match = TRACE_LINE.search(line)
+            if match:
+                dump += bytes.fromhex(match.group(1))
+    return last
+
+
+def to_events(data):
+    events = []
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        time_ms, phase, event, arg = RECORD.unpack_from(data, offset)
+        name = EVENTS[event] if event < len(EVENTS) else 'event %d' % event
+        record = {
+            'name': name,
+            'ph': PHASES[phase] if phase < len(PHASES) else 'i',
+            'ts': time_ms * 1000,
+            'pid': 1,
+            'tid': 1,
+        }
+        if record['ph'] == 'i':
+            record['s'] = 't'
+            record['args'] = {'arg': arg}
+        events.append(record)
+    return events
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.stderr.write(__doc__)
+        return 2
+    with open(argv[1], errors='replace') as f:
+        data = last_dump(f)
+    if not data:
+        sys.stderr.write('no complete TRACE-BEGIN/TRACE-END dump found\n')
+        return 1
+    json.dump({'traceEvents': to_events(data), 'displayTimeUnit': 'ms'}, sys.stdout)
+    sys.stdout.write('\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""Compile a spawn wave script into the bytecode the app streams.
+
+Wave mode (hold UP on the menu) spawns beans from a script instead of the
+random spawner. Scripts are plain text, one statement per line, '#' starts
+a comment. Times are simulation ticks (30 per second) or seconds with an
+'s' suffix; '?' means random, drawn the way the random spawner draws it.
+
+    bean COL [TYPE] [SPEED]      spawn one bean: COL 0-19 or ?, TYPE green,
+                                 pink or ? (pink only while a block is
+                                 missing), SPEED fall speed in hundredths
+                                 (1-255) or ? (50-149)
+    wait TIME                    pause the script (at least one tick)
+    repeat N ... end             run the block N times (1-255), nested up
+                                 to 3 deep
+    sweep FROM TO EVERY [TYPE] [SPEED]
+                                 one bean per column from FROM to TO
+                                 (either direction), EVERY apart
+    label NAME / goto NAME       jump within the script (outside repeat
+                                 blocks only)
+    endless                      hand over to the random spawner for the
+                                 rest of the run (also implied at the end)
+
+sweep is expanded here into bean and wait instructions, so the interpreter
+only knows five opcodes. File layout (little endian):
+
+    0  'W' 'V'     magic
+    2  uint8       version (1)
+    3  uint8       reserved
+    4  uint16      code size in bytes
+    6  code        0x00 endless
+                   0x01 bean: uint8 column (255 ?), uint8 BeanType (255 ?),
+                        uint8 speed (0 ?)
+                   0x02 wait: uint16 ticks
+                   0x03 repeat: uint8 count; the block follows
+                   0x04 end of a repeat block
+                   0x05 goto: uint16 code offset
+
+Keep the opcodes, WAVE_MAX_DEPTH and the bean types in step with the wave
+interpreter in src/c/birdbeansgame.c.
+
+Usage: tools/wavec.py [script.wave out.bin]
+       (no arguments: every resources/waves/*.wave into a .bin beside it)
+"""
+import glob
+import os
+import struct
+import sys
+
+GAME_WIDTH = 20
+TICKS_PER_SECOND = 30
+MAX_DEPTH = 3
+VERSION = 1
+RANDOM = 255
+BEAN_TYPES = {'green': 0, 'pink': 1, '?': RANDOM}
+
+OP_ENDLESS = 0x00
+OP_BEAN = 0x01
+OP_WAIT = 0x02
+OP_REPEAT = 0x03
+OP_END = 0x04
+OP_GOTO = 0x05
+
+
+class WaveError(Exception):
+    pass
+
+
+def parse_ticks(text):
+    try:
+        ticks = round(float(text[:-1]) * TICKS_PER_SECOND) if text.endswith('s') else int(text)
+    except ValueError:
+        raise WaveError('bad time %r' % text)
+    if not 0 <= ticks <= 0xFFFF:
+        raise WaveError('time %r out of range' % text)
+    return ticks
+
+
+def parse_column(text):
+    if text == '?':
+        return RANDOM
+    if not text.isdigit() or int(text) >= GAME_WIDTH:
+        raise WaveError('column %r is not 0-%d or ?' % (text, GAME_WIDTH - 1))
+    return int(text)
+
+
+def parse_bean_options(args):
+    if len(args) > 2:
+        raise WaveError('too many arguments')
+    bean_type = args[0] if args else '?'
+    if bean_type not in BEAN_TYPES:
+        raise WaveError('unknown bean type %r' % bean_type)
+    speed = args[1] if len(args) > 1 else '?'
+    if speed == '?':
+        speed = 0
+    elif not speed.isdigit() or not 1 <= int(speed) <= 255:
+        raise WaveError('speed %r is not 1-255 or ?' % speed)
+    return BEAN_TYPES[bean_type], int(speed)
+
+
+def compile_script(lines):
+    code = bytearray()
+    labels = {}
+    gotos = []  # (code offset of the operand, label, line number)
+    blocks = []
+    for number, line in enumerate(lines, 1):
+        words = line.split('#', 1)[0].split()
+        if not words:
+            continue
+        op, args = words[0], words[1:]
+        try:
+            if op == 'bean':
+                if not args:
+                    raise WaveError('bean needs a column')
+                bean_type, speed = parse_bean_options(args[1:])
+                code += struct.pack('<BBBB', OP_BEAN, parse_column(args[0]), bean_type, speed)
+            elif op == 'wait' and len(args) == 1:
+                ticks = parse_ticks(args[0])
+                if ticks == 0:
+                    raise WaveError('wait must be at least one tick')
+                code += struct.pack('<BH', OP_WAIT, ticks)
+            elif op == 'repeat' and len(args) == 1:
+                if not args[0].isdigit() or not 1 <= int(args[0]) <= 255:
+                    raise WaveError('repeat count %r is not 1-255' % args[0])
+                if len(blocks) == MAX_DEPTH:
+                    raise WaveError('repeat blocks nest at most %d deep' % MAX_DEPTH)
+                code += struct.pack('<BB', OP_REPEAT, int(args[0]))
+                blocks.append(number)
+            elif op == 'end' and not args:
+                if not blocks:
+                    raise WaveError('end without repeat')
+                blocks.pop()
+                code.append(OP_END)
+            elif op == 'sweep' and len(args) >= 3:
+                first, last = parse_column(args[0]), parse_column(args[1])
+                if RANDOM in (first, last):
+                    raise WaveError('sweep needs fixed columns')
+                every = parse_ticks(args[2])
+                if every == 0:
+                    raise WaveError('sweep beans must be at least one tick apart')
+                bean_type, speed = parse_bean_options(args[3:])
+                step = 1 if last >= first else -1
+                for column in range(first, last + step, step):
+                    if column != first:
+                        code += struct.pack('<BH', OP_WAIT, every)
+                    code += struct.pack('<BBBB', OP_BEAN, column, bean_type, speed)
+            elif op in ('label', 'goto') and blocks:
+                raise WaveError('%s inside a repeat block' % op)
+            elif op == 'label' and len(args) == 1:
+                if args[0] in labels:
+                    raise WaveError('label %r defined twice' % args[0])
+                labels[args[0]] = len(code)
+            elif op == 'goto' and len(args) == 1:
+                code.append(OP_GOTO)
+                gotos.append((len(code), args[0], number))
+                code += b'\0\0'
+            elif op == 'endless' and not args:
+                code.append(OP_ENDLESS)
+            else:
+                raise WaveError('bad statement %r' % line.strip())
+        except WaveError as error:
+            raise WaveError('line %d: %s' % (number, error))
+    if blocks:
+        raise WaveError('line %d: repeat without end' % blocks[-1])
+    for offset, label, number in gotos:
+        if label not in labels:
+            raise WaveError('line %d: unknown label %r' % (number, label))
+        struct.pack_into('<H', code, offset, labels[label])
+    code.append(OP_ENDLESS)
+    if len(code) > 0xFFFF:
+        raise WaveError('script is %d bytes, more than 64 KB' % len(code))
+    return b'WV' + struct.pack('<BBH', VERSION, 0, len(code)) + bytes(code)
+
+
+def compile_file(source, target):
+    with open(source) as f:
+        try:
+            data = compile_script(f)
+        except WaveError as error:
+            raise WaveError('%s: %s' % (source, error))
+    with open(target, 'wb') as out:
+        out.write(data)
+    return len(data)
+
+
+def compile_all(root='.'):
+    """Compile every resources/waves/*.wave whose .bin is missing or older."""
+    for source in sorted(glob.glob(os.path.join(root, 'resources', 'waves', '*.wave'))):
+        target = os.path.splitext(source)[0] + '.bin'
+        if not os.path.exists(target) or os.path.getmtime(target) < os.path.getmtime(source):
+            print('%s -> %s (%d bytes)' % (source, target, compile_file(source, target)))
+
+
+def main():
+    try:
+        if len(sys.argv) == 3:
+            print('%s -> %s (%d bytes)' % (sys.argv[1], sys.argv[2], compile_file(*sys.argv[1:])))
+        elif len(sys.argv) == 1:
+            compile_all()
+        else:
+            sys.exit(__doc__)
+    except WaveError as error:
+        sys.exit(str(error))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())